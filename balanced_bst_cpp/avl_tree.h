@@ -0,0 +1,280 @@
+#ifndef AVL_TREE_H
+#define AVL_TREE_H
+
+#include <cassert>
+#include <cstddef>
+#include <algorithm>
+#include <iterator>
+#include <new>
+#include <vector>
+#include "balanced_tree.h"
+#include "height_tracked_tree.h"
+
+// Ordered set of ints kept height-balanced with AVL rotations. Nodes are
+// TrackedNodes, so root() is an ordinary Node tree; debug builds verify the
+// AVL invariant with isTreeBalanced after every insert and erase.
+class AvlTree {
+public:
+    // In-order forward iterator. Stays valid until its element is erased.
+    class const_iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef int value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const int* pointer;
+        typedef const int& reference;
+
+        const_iterator() : node_(nullptr) {}
+
+        reference operator*() const { return node_->node.data; }
+        pointer operator->() const { return &node_->node.data; }
+
+        const_iterator& operator++() {
+            if (node_->node.right != nullptr) {
+                node_ = leftmost(tracked(node_->node.right));
+            } else {
+                const TrackedNode* child = node_;
+                node_ = node_->parent;
+                while (node_ != nullptr && node_->node.right == &child->node) {
+                    child = node_;
+                    node_ = node_->parent;
+                }
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const const_iterator& other) const { return node_ == other.node_; }
+        bool operator!=(const const_iterator& other) const { return node_ != other.node_; }
+
+    private:
+        friend class AvlTree;
+        explicit const_iterator(const TrackedNode* node) : node_(node) {}
+        const TrackedNode* node_;
+    };
+
+    typedef const_iterator iterator;
+
+    AvlTree() : root_(nullptr), size_(0) {}
+    ~AvlTree() { clear(); }
+
+    AvlTree(const AvlTree&) = delete;
+    AvlTree& operator=(const AvlTree&) = delete;
+
+    // Root as a plain Node tree, for the checkers in balanced_tree.h
+    Node* root() const { return root_ ? &root_->node : nullptr; }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    int height() const { return heightOf(root_); }
+
+    const_iterator begin() const { return const_iterator(root_ ? leftmost(root_) : nullptr); }
+    const_iterator end() const { return const_iterator(); }
+
+    const_iterator find(int key) const {
+        const Node* current = root();
+        while (current != nullptr) {
+            if (key == current->data) return const_iterator(tracked(current));
+            current = key < current->data ? current->left : current->right;
+        }
+        return end();
+    }
+
+    bool contains(int key) const { return find(key) != end(); }
+
+    // First element not less than key
+    const_iterator lower_bound(int key) const {
+        const Node* current = root();
+        const Node* best = nullptr;
+        while (current != nullptr) {
+            if (current->data < key) {
+                current = current->right;
+            } else {
+                best = current;
+                current = current->left;
+            }
+        }
+        return const_iterator(best ? tracked(best) : nullptr);
+    }
+
+    // Inserts key; returns false if it was already present or allocation failed
+    bool insert(int key) {
+        TrackedNode* parent = nullptr;
+        Node* current = root();
+        while (current != nullptr) {
+            if (key == current->data) return false;
+            parent = tracked(current);
+            current = key < current->data ? current->left : current->right;
+        }
+        TrackedNode* created = new (std::nothrow) TrackedNode();
+        if (created == nullptr) return false;
+        created->node.data = key;
+        created->node.left = created->node.right = nullptr;
+        created->parent = nullptr;
+        created->height = 1;
+        created->balanced = true;
+        if (parent == nullptr) {
+            root_ = created;
+        } else if (key < parent->node.data) {
+            setLeft(parent, created);
+        } else {
+            setRight(parent, created);
+        }
+        ++size_;
+        retrace(parent);
+        // Debug builds re-verify the whole tree; this is O(n) per insert
+        assert(isTreeBalanced(root()));
+        return true;
+    }
+
+    // Removes key; returns the number of elements erased (0 or 1)
+    size_t erase(int key) {
+        const_iterator position = find(key);
+        if (position == end()) return 0;
+        erase(position);
+        return 1;
+    }
+
+    // Removes the element at position, which must be dereferenceable.
+    // Other iterators remain valid: nodes are relinked, never copied.
+    void erase(const_iterator position) {
+        TrackedNode* victim = const_cast<TrackedNode*>(position.node_);
+        TrackedNode* retraceFrom;
+        if (victim->node.left != nullptr && victim->node.right != nullptr) {
+            // Move the in-order successor into the victim's place
+            TrackedNode* successor = leftmost(right(victim));
+            if (successor->parent != victim) {
+                retraceFrom = successor->parent;
+                setLeft(successor->parent, right(successor));
+                setRight(successor, right(victim));
+            } else {
+                retraceFrom = successor;
+            }
+            replaceChild(victim->parent, victim, successor);
+            setLeft(successor, left(victim));
+            successor->height = victim->height;
+        } else {
+            TrackedNode* child = victim->node.left ? left(victim) : right(victim);
+            retraceFrom = victim->parent;
+            replaceChild(victim->parent, victim, child);
+        }
+        delete victim;
+        --size_;
+        retrace(retraceFrom);
+        // Debug builds re-verify the whole tree; this is O(n) per erase
+        assert(isTreeBalanced(root()));
+    }
+
+    void clear() {
+        std::vector<TrackedNode*> pending;
+        if (root_ != nullptr) pending.push_back(root_);
+        while (!pending.empty()) {
+            TrackedNode* node = pending.back();
+            pending.pop_back();
+            if (node->node.left != nullptr) pending.push_back(left(node));
+            if (node->node.right != nullptr) pending.push_back(right(node));
+            delete node;
+        }
+        root_ = nullptr;
+        size_ = 0;
+    }
+
+private:
+    static TrackedNode* left(const TrackedNode* node) {
+        return node->node.left ? tracked(node->node.left) : nullptr;
+    }
+
+    static TrackedNode* right(const TrackedNode* node) {
+        return node->node.right ? tracked(node->node.right) : nullptr;
+    }
+
+    static const TrackedNode* leftmost(const TrackedNode* node) {
+        while (node->node.left != nullptr) node = tracked(node->node.left);
+        return node;
+    }
+
+    static TrackedNode* leftmost(TrackedNode* node) {
+        while (node->node.left != nullptr) node = tracked(node->node.left);
+        return node;
+    }
+
+    static int heightOf(const TrackedNode* node) { return node ? node->height : 0; }
+
+    static void setLeft(TrackedNode* parent, TrackedNode* child) {
+        parent->node.left = child ? &child->node : nullptr;
+        if (child != nullptr) child->parent = parent;
+    }
+
+    static void setRight(TrackedNode* parent, TrackedNode* child) {
+        parent->node.right = child ? &child->node : nullptr;
+        if (child != nullptr) child->parent = parent;
+    }
+
+    // Puts replacement where child hangs under parent (or at the root)
+    void replaceChild(TrackedNode* parent, TrackedNode* child, TrackedNode* replacement) {
+        if (parent == nullptr) {
+            root_ = replacement;
+            if (replacement != nullptr) replacement->parent = nullptr;
+        } else if (parent->node.left == &child->node) {
+            setLeft(parent, replacement);
+        } else {
+            setRight(parent, replacement);
+        }
+    }
+
+    static void updateHeight(TrackedNode* node) {
+        node->height = std::max(heightOf(left(node)), heightOf(right(node))) + 1;
+    }
+
+    TrackedNode* rotateLeft(TrackedNode* node) {
+        TrackedNode* pivot = right(node);
+        setRight(node, left(pivot));
+        replaceChild(node->parent, node, pivot);
+        setLeft(pivot, node);
+        updateHeight(node);
+        updateHeight(pivot);
+        return pivot;
+    }
+
+    TrackedNode* rotateRight(TrackedNode* node) {
+        TrackedNode* pivot = left(node);
+        setLeft(node, right(pivot));
+        replaceChild(node->parent, node, pivot);
+        setRight(pivot, node);
+        updateHeight(node);
+        updateHeight(pivot);
+        return pivot;
+    }
+
+    // Restores the AVL property at node; returns the subtree's new root
+    TrackedNode* rebalance(TrackedNode* node) {
+        int balance = heightOf(left(node)) - heightOf(right(node));
+        if (balance > 1) {
+            if (heightOf(left(left(node))) < heightOf(right(left(node)))) rotateLeft(left(node));
+            return rotateRight(node);
+        }
+        if (balance < -1) {
+            if (heightOf(right(right(node))) < heightOf(left(right(node)))) rotateRight(right(node));
+            return rotateLeft(node);
+        }
+        return node;
+    }
+
+    // Walks from node to the root fixing heights and rotating where needed
+    void retrace(TrackedNode* node) {
+        while (node != nullptr) {
+            updateHeight(node);
+            node = rebalance(node)->parent;
+        }
+    }
+
+    TrackedNode* root_;
+    size_t size_;
+};
+
+#endif // AVL_TREE_H
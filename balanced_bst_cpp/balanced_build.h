@@ -0,0 +1,118 @@
+#ifndef BALANCED_BUILD_H
+#define BALANCED_BUILD_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+#include "balanced_tree.h"
+
+// Builds a perfectly balanced search tree from n keys sorted ascending, in
+// O(n) time with one allocation. Nodes are laid out in pre-order, so the
+// root is the first node of the block: release the tree with
+// deleteBalancedTree, not deleteTree. Returns nullptr if n is 0 or the block
+// could not be allocated.
+inline Node* buildBalanced(const int* sorted, size_t n) {
+    if (n == 0) return nullptr;
+    Node* nodes = new (std::nothrow) Node[n];
+    if (nodes == nullptr) {
+        logBalanceError(BalanceError::OutOfMemory);
+        return nullptr;
+    }
+
+    // Each pending range [lo, hi) becomes the subtree hanging from *link.
+    // Popping the left range first emits nodes in pre-order; the stack never
+    // holds more than about two ranges per level.
+    struct Range {
+        size_t lo, hi;
+        Node** link;
+    };
+    Node* root = nullptr;
+    std::vector<Range> pending;
+    Range whole = { 0, n, &root };
+    pending.push_back(whole);
+    size_t next = 0;
+    while (!pending.empty()) {
+        Range range = pending.back();
+        pending.pop_back();
+        size_t mid = range.lo + (range.hi - range.lo) / 2;
+        Node* node = &nodes[next++];
+        node->data = sorted[mid];
+        node->left = node->right = nullptr;
+        *range.link = node;
+        if (mid + 1 < range.hi) {
+            Range right = { mid + 1, range.hi, &node->right };
+            pending.push_back(right);
+        }
+        if (range.lo < mid) {
+            Range left = { range.lo, mid, &node->left };
+            pending.push_back(left);
+        }
+    }
+    return root;
+}
+
+// Releases a tree returned by buildBalanced. The tree may have been
+// rebalanced since, but no nodes may have been added or removed.
+inline void deleteBalancedTree(Node* block) {
+    delete[] block;
+}
+
+namespace balanced_build_detail {
+
+// Left-rotates `count` alternate nodes down the right spine below scanner
+inline void compress(Node* scanner, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        Node* child = scanner->right;
+        scanner->right = child->right;
+        scanner = scanner->right;
+        child->right = scanner->left;
+        scanner->left = child;
+    }
+}
+
+} // namespace balanced_build_detail
+
+// Day-Stout-Warren rebalancing: rotates the tree into a right-leaning vine
+// and then compresses the vine into a balanced tree whose levels are all
+// full except possibly the last. Works in place with O(1) extra memory and
+// no recursion; returns the new root. Node identities are preserved, so a
+// tree from buildBalanced keeps its block.
+inline Node* rebalance(Node* root) {
+    Node pseudoRoot;
+    pseudoRoot.left = nullptr;
+    pseudoRoot.right = root;
+
+    // Tree to vine: right-rotate every left child up into the spine
+    Node* tail = &pseudoRoot;
+    Node* rest = root;
+    size_t size = 0;
+    while (rest != nullptr) {
+        if (rest->left == nullptr) {
+            tail = rest;
+            rest = rest->right;
+            size++;
+        } else {
+            Node* pivot = rest->left;
+            rest->left = pivot->right;
+            pivot->right = rest;
+            rest = pivot;
+            tail->right = pivot;
+        }
+    }
+
+    // Vine to tree: first place the nodes of an incomplete bottom level,
+    // then halve the spine until it is a single node.
+    size_t fullLevels = 1;
+    while (fullLevels <= size + 1) fullLevels <<= 1;
+    fullLevels >>= 1;
+    size_t leaves = size + 1 - fullLevels;
+    balanced_build_detail::compress(&pseudoRoot, leaves);
+    size -= leaves;
+    while (size > 1) {
+        size /= 2;
+        balanced_build_detail::compress(&pseudoRoot, size);
+    }
+    return pseudoRoot.right;
+}
+
+#endif // BALANCED_BUILD_H
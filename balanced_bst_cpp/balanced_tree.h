@@ -0,0 +1,307 @@
+#ifndef BALANCED_TREE_H
+#define BALANCED_TREE_H
+
+#include <climits>   // For INT_MAX
+#include <cstdint>
+#include <cstdlib>   // For std::abs, std::realloc, std::free
+#include <new>       // For std::nothrow
+#include <algorithm>
+#include <atomic>
+#include <type_traits>
+
+// Define the structure for a binary tree node
+struct Node {
+    int data;
+    Node* left;
+    Node* right;
+};
+
+// Why a balance check (or a node allocation) did not succeed
+enum class BalanceError : uint8_t {
+    None = 0,            // balanced
+    Unbalanced,          // some subtree's heights differ by more than one
+    DepthLimitExceeded,  // the recursive checker hit its maxDepth
+    HeightOverflow,      // a height would not fit in an int
+    OutOfMemory,         // a node or the traversal stack could not be allocated
+    MalformedInput       // a serialized tree's structure is inconsistent
+};
+
+inline const char* balanceErrorMessage(BalanceError error) {
+    switch (error) {
+    case BalanceError::None: return "Tree is balanced.";
+    case BalanceError::Unbalanced: return "Tree is not balanced.";
+    case BalanceError::DepthLimitExceeded: return "Maximum depth exceeded, possible stack overflow.";
+    case BalanceError::HeightOverflow: return "Height calculation overflow detected.";
+    case BalanceError::OutOfMemory: return "Memory allocation failed";
+    case BalanceError::MalformedInput: return "Serialized tree structure is malformed.";
+    }
+    return "Unknown error";
+}
+
+// Outcome of a balance check. height is only meaningful when balanced.
+struct BalanceResult {
+    int height;
+    bool balanced;
+    BalanceError error;
+
+    static BalanceResult success(int height) {
+        BalanceResult result = { height, true, BalanceError::None };
+        return result;
+    }
+
+    static BalanceResult failure(BalanceError error) {
+        BalanceResult result = { 0, false, error };
+        return result;
+    }
+};
+
+// Optional diagnostics hook. The library never throws or writes to stdout;
+// conditions worth reporting (depth limit, overflow, allocation failure) are
+// passed to the installed callback instead. Install it before starting any
+// checks; it is not synchronised with concurrent checkers.
+typedef void (*BalanceLogFn)(BalanceError error, const char* message, void* context);
+
+struct BalanceLogger {
+    BalanceLogFn fn;
+    void* context;
+};
+
+inline BalanceLogger& balanceLogger() {
+    static BalanceLogger logger = { nullptr, nullptr };
+    return logger;
+}
+
+inline void setBalanceLogger(BalanceLogFn fn, void* context = nullptr) {
+    balanceLogger().fn = fn;
+    balanceLogger().context = context;
+}
+
+inline void logBalanceError(BalanceError error) {
+    const BalanceLogger& logger = balanceLogger();
+    if (logger.fn != nullptr) logger.fn(error, balanceErrorMessage(error), logger.context);
+}
+
+// Function to create a new binary tree node with input validation
+inline Node* createNode(int data) {
+    Node* newNode = new (std::nothrow) Node();
+    if (newNode == nullptr) {
+        logBalanceError(BalanceError::OutOfMemory);
+        return nullptr;
+    }
+    newNode->data = data;
+    newNode->left = newNode->right = nullptr;
+    return newNode;
+}
+
+// Function to safely delete a binary tree to prevent memory leaks.
+// Left children are rotated up until the current node has none, after which
+// it can be freed and its right subtree taken next. This needs no stack at
+// all, so trees of any depth are freed without allocating or recursing.
+inline void deleteTree(Node* root) {
+    while (root != nullptr) {
+        if (root->left != nullptr) {
+            Node* pivot = root->left;
+            root->left = pivot->right;
+            pivot->right = root;
+            root = pivot;
+        } else {
+            Node* next = root->right;
+            delete root;
+            root = next;
+        }
+    }
+}
+
+namespace balanced_tree_detail {
+
+inline int checkBalanceRecursive(const Node* root, int maxDepth, int currentDepth, BalanceError& error) {
+    if (root == nullptr) return 0;
+
+    if (currentDepth > maxDepth) {
+        error = BalanceError::DepthLimitExceeded;
+        return -1;
+    }
+
+    // Left subtree height
+    int leftHeight = checkBalanceRecursive(root->left, maxDepth, currentDepth + 1, error);
+    if (leftHeight < 0) return -1;
+
+    // Right subtree height
+    int rightHeight = checkBalanceRecursive(root->right, maxDepth, currentDepth + 1, error);
+    if (rightHeight < 0) return -1;
+
+    // Check balance condition
+    if (std::abs(leftHeight - rightHeight) > 1) {
+        error = BalanceError::Unbalanced;
+        return -1;
+    }
+
+    // Avoid integer overflow when calculating height
+    if (leftHeight > INT_MAX - 1 || rightHeight > INT_MAX - 1) {
+        error = BalanceError::HeightOverflow;
+        return -1;
+    }
+
+    return std::max(leftHeight, rightHeight) + 1;
+}
+
+} // namespace balanced_tree_detail
+
+// Recursive reference implementation: checks if a binary tree is balanced and
+// calculates its height. Kept for comparison with the iterative engine below;
+// it needs one call frame per level and therefore stops with
+// DepthLimitExceeded below maxDepth levels.
+inline BalanceResult checkBalanceAndHeight(const Node* root, int maxDepth) {
+    BalanceError error = BalanceError::None;
+    int height = balanced_tree_detail::checkBalanceRecursive(root, maxDepth, 0, error);
+    if (error == BalanceError::None) return BalanceResult::success(height);
+    if (error != BalanceError::Unbalanced) logBalanceError(error);
+    return BalanceResult::failure(error);
+}
+
+// One pending node of the iterative post-order walk. leftHeight is only
+// meaningful once leftDone is set.
+struct BalanceFrame {
+    const Node* node;
+    int leftHeight;
+    bool leftDone;
+};
+
+// Growable frame buffer for the iterative checkers. Growth is reported as a
+// failed reserve() rather than an exception, and a stack kept by the caller
+// stops allocating once it has reached the deepest tree it has seen. Frames
+// are moved with realloc, so Frame must be trivially copyable.
+template <class Frame>
+class BasicBalanceStack {
+public:
+    static_assert(std::is_trivially_copyable<Frame>::value, "frames are moved with realloc");
+
+    BasicBalanceStack() : frames_(nullptr), capacity_(0) {}
+    ~BasicBalanceStack() { std::free(frames_); }
+
+    BasicBalanceStack(BasicBalanceStack&& other) noexcept : frames_(other.frames_), capacity_(other.capacity_) {
+        other.frames_ = nullptr;
+        other.capacity_ = 0;
+    }
+
+    BasicBalanceStack& operator=(BasicBalanceStack&& other) noexcept {
+        std::swap(frames_, other.frames_);
+        std::swap(capacity_, other.capacity_);
+        return *this;
+    }
+
+    BasicBalanceStack(const BasicBalanceStack&) = delete;
+    BasicBalanceStack& operator=(const BasicBalanceStack&) = delete;
+
+    // Makes room for at least `frames` frames; false if memory ran out
+    bool reserve(size_t frames) {
+        if (frames <= capacity_) return true;
+        size_t capacity = std::max(frames, std::max<size_t>(capacity_ * 2, 64));
+        void* grown = std::realloc(frames_, capacity * sizeof(Frame));
+        if (grown == nullptr) return false;
+        frames_ = static_cast<Frame*>(grown);
+        capacity_ = capacity;
+        return true;
+    }
+
+    Frame* data() { return frames_; }
+    size_t capacity() const { return capacity_; }
+
+private:
+    Frame* frames_;
+    size_t capacity_;
+};
+
+typedef BasicBalanceStack<BalanceFrame> BalanceStack;
+
+// Special return values of checkBalanceIterative
+const int HEIGHT_UNBALANCED = -1;
+const int HEIGHT_OUT_OF_MEMORY = -2;
+
+// Iterative post-order balance check. Returns the height of the tree,
+// HEIGHT_UNBALANCED as soon as any subtree is found unbalanced, or
+// HEIGHT_OUT_OF_MEMORY if the stack could not grow. The explicit stack lives
+// on the heap and holds at most one frame per level, so memory is O(height)
+// and there is no depth limit. The caller may pass a scratch stack to reuse
+// its capacity across calls. If cancel is given, the walk gives up and
+// returns HEIGHT_UNBALANCED once it is set, so concurrent checkers can stop
+// each other early.
+inline int checkBalanceIterative(const Node* root, BalanceStack& stack,
+                                 const std::atomic<bool>* cancel = nullptr) {
+    if (!stack.reserve(64)) return HEIGHT_OUT_OF_MEMORY;
+    BalanceFrame* frames = stack.data();
+    size_t capacity = stack.capacity();
+    size_t depth = 0;
+    const Node* current = root;
+    int height;
+    for (;;) {
+        // Descend along left children, deferring each inner node until its
+        // subtrees have been measured. Leaves are resolved without a frame.
+        height = 0;
+        while (current != nullptr) {
+            if (current->left == nullptr && current->right == nullptr) {
+                height = 1;
+                break;
+            }
+            if (depth == capacity) {
+                if (!stack.reserve(capacity + 1)) return HEIGHT_OUT_OF_MEMORY;
+                frames = stack.data();
+                capacity = stack.capacity();
+            }
+            BalanceFrame& frame = frames[depth++];
+            frame.node = current;
+            frame.leftDone = false;
+            current = current->left;
+        }
+        current = nullptr;
+
+        // Unwind completed subtrees until a right child needs visiting.
+        while (depth > 0) {
+            BalanceFrame& top = frames[depth - 1];
+            if (!top.leftDone) {
+                top.leftDone = true;
+                top.leftHeight = height;
+                if (top.node->right != nullptr) {
+                    if (cancel != nullptr && cancel->load(std::memory_order_relaxed)) {
+                        return HEIGHT_UNBALANCED;
+                    }
+                    current = top.node->right;
+                    break;
+                }
+                height = 0;
+            }
+            if (std::abs(top.leftHeight - height) > 1) return HEIGHT_UNBALANCED;
+            height = std::max(top.leftHeight, height) + 1;
+            --depth;
+        }
+        if (current == nullptr) return height;
+    }
+}
+
+inline int checkBalanceIterative(const Node* root) {
+    BalanceStack stack;
+    return checkBalanceIterative(root, stack);
+}
+
+// Iterative check with a status result; allocation failure is also logged
+inline BalanceResult checkBalance(const Node* root, BalanceStack& stack) {
+    int height = checkBalanceIterative(root, stack);
+    if (height >= 0) return BalanceResult::success(height);
+    if (height == HEIGHT_OUT_OF_MEMORY) {
+        logBalanceError(BalanceError::OutOfMemory);
+        return BalanceResult::failure(BalanceError::OutOfMemory);
+    }
+    return BalanceResult::failure(BalanceError::Unbalanced);
+}
+
+inline BalanceResult checkBalance(const Node* root) {
+    BalanceStack stack;
+    return checkBalance(root, stack);
+}
+
+// Wrapper function to check if a binary tree is balanced
+inline bool isTreeBalanced(const Node* root) {
+    return checkBalanceIterative(root) >= 0;
+}
+
+#endif // BALANCED_TREE_H
@@ -0,0 +1,144 @@
+#ifndef BATCH_BALANCE_H
+#define BATCH_BALANCE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "balanced_tree.h"
+
+// Validates many trees per call on a fixed pool of worker threads. Each
+// worker keeps its own traversal stack across trees and batches, so steady
+// state validation performs no allocation and never writes to stdout.
+// One batch runs at a time; validate() is not reentrant.
+class BatchBalanceValidator {
+public:
+    // threads counts the calling thread; 0 means hardware_concurrency()
+    explicit BatchBalanceValidator(unsigned threads = 0)
+        : roots_(nullptr), count_(0), balancedBits_(nullptr), errors_(nullptr),
+          nextChunk_(0), generation_(0), busyWorkers_(0), stopping_(false) {
+        if (threads == 0) threads = std::thread::hardware_concurrency();
+        if (threads == 0) threads = 1;
+        scratch_.resize(threads);
+        for (unsigned i = 1; i < threads; i++) {
+            workers_.push_back(std::thread(&BatchBalanceValidator::workerLoop, this, i));
+        }
+    }
+
+    ~BatchBalanceValidator() {
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (size_t i = 0; i < workers_.size(); i++) workers_[i].join();
+    }
+
+    BatchBalanceValidator(const BatchBalanceValidator&) = delete;
+    BatchBalanceValidator& operator=(const BatchBalanceValidator&) = delete;
+
+    unsigned threads() const { return static_cast<unsigned>(scratch_.size()); }
+
+    // Checks roots[0..count). Bit i of balancedBits (which must hold
+    // (count + 63) / 64 words) is set iff tree i is balanced. If errors is
+    // not null, errors[i] receives the reason tree i failed. Returns the
+    // number of balanced trees.
+    size_t validate(const Node* const* roots, size_t count, uint64_t* balancedBits,
+                    BalanceError* errors = nullptr) {
+        if (count == 0) return 0;
+        roots_ = roots;
+        count_ = count;
+        balancedBits_ = balancedBits;
+        errors_ = errors;
+        nextChunk_.store(0, std::memory_order_relaxed);
+        balancedCount_.store(0, std::memory_order_relaxed);
+
+        if (!workers_.empty() && count > CHUNK_TREES) {
+            {
+                std::lock_guard<std::mutex> guard(lock_);
+                busyWorkers_ = static_cast<unsigned>(workers_.size());
+                ++generation_;
+            }
+            wake_.notify_all();
+            drainChunks(0);
+            std::unique_lock<std::mutex> guard(lock_);
+            done_.wait(guard, [this] { return busyWorkers_ == 0; });
+        } else {
+            drainChunks(0);
+        }
+        return balancedCount_.load(std::memory_order_relaxed);
+    }
+
+private:
+    // Trees per unit of work. A multiple of 64 so that no two threads ever
+    // write the same bitmap word.
+    static const size_t CHUNK_TREES = 512;
+
+    void drainChunks(unsigned self) {
+        BalanceStack& stack = scratch_[self];
+        size_t balanced = 0;
+        for (;;) {
+            size_t begin = nextChunk_.fetch_add(1, std::memory_order_relaxed) * CHUNK_TREES;
+            if (begin >= count_) break;
+            size_t end = begin + CHUNK_TREES < count_ ? begin + CHUNK_TREES : count_;
+            for (size_t word = begin; word < end; word += 64) {
+                uint64_t bits = 0;
+                size_t wordEnd = word + 64 < end ? word + 64 : end;
+                for (size_t i = word; i < wordEnd; i++) {
+                    BalanceError error = checkOne(roots_[i], stack);
+                    if (error == BalanceError::None) bits |= uint64_t(1) << (i - word);
+                    if (errors_ != nullptr) errors_[i] = error;
+                }
+                balancedBits_[word / 64] = bits;
+                balanced += __builtin_popcountll(bits);
+            }
+        }
+        balancedCount_.fetch_add(balanced, std::memory_order_relaxed);
+    }
+
+    static BalanceError checkOne(const Node* root, BalanceStack& stack) {
+        int height = checkBalanceIterative(root, stack);
+        if (height >= 0) return BalanceError::None;
+        // Out of memory is only possible when a degenerate tree outgrows the
+        // scratch stack
+        return height == HEIGHT_OUT_OF_MEMORY ? BalanceError::OutOfMemory : BalanceError::Unbalanced;
+    }
+
+    void workerLoop(unsigned self) {
+        unsigned long seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> guard(lock_);
+                wake_.wait(guard, [&] { return stopping_ || generation_ != seen; });
+                if (stopping_) return;
+                seen = generation_;
+            }
+            drainChunks(self);
+            {
+                std::lock_guard<std::mutex> guard(lock_);
+                if (--busyWorkers_ == 0) done_.notify_one();
+            }
+        }
+    }
+
+    // Current batch; written by validate() before workers are woken
+    const Node* const* roots_;
+    size_t count_;
+    uint64_t* balancedBits_;
+    BalanceError* errors_;
+    std::atomic<size_t> nextChunk_;
+    std::atomic<size_t> balancedCount_;
+
+    std::vector<BalanceStack> scratch_;
+    std::vector<std::thread> workers_;
+    std::mutex lock_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    unsigned long generation_;
+    unsigned busyWorkers_;
+    bool stopping_;
+};
+
+#endif // BATCH_BALANCE_H
@@ -0,0 +1,1225 @@
+// Benchmarks for the balance checkers in balanced_tree.h.
+//
+//   g++ -std=c++11 -O2 -DNDEBUG -pthread bench_balanced_tree.cpp -o bench_balanced_tree
+//   (without -DNDEBUG AvlTree re-verifies itself after every update)
+//   ./bench_balanced_tree                          run every section
+//   ./bench_balanced_tree iterative [height] [chain_depth]
+//   ./bench_balanced_tree arena [height]
+//   ./bench_balanced_tree flat [max_nodes]       (1e8 nodes needs ~5 GB)
+//   ./bench_balanced_tree parallel [nodes] [max_threads]
+//   ./bench_balanced_tree incremental [operations]
+//   ./bench_balanced_tree avl [keys]
+//   ./bench_balanced_tree bulk [max_keys]         (1e8 keys needs ~3 GB)
+//   ./bench_balanced_tree batch [trees] [max_threads]
+//   ./bench_balanced_tree errors [calls]
+//   ./bench_balanced_tree file [nodes] [path]
+//   ./bench_balanced_tree stream [nodes] [path]   (3e8 nodes is a ~3 GB stream)
+//   ./bench_balanced_tree generic [height]
+//   ./bench_balanced_tree stats [height] [chain_depth]
+//   ./bench_balanced_tree prefetch [height]       (height 27 needs ~3 GB)
+//   ./bench_balanced_tree suite [max_nodes] [json_path]   (1e8 nodes needs ~3 GB)
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <random>
+#include <map>
+#include <algorithm>
+#include <functional>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "balanced_tree.h"
+#include "node_arena.h"
+#include "flat_tree.h"
+#include "parallel_balance.h"
+#include "height_tracked_tree.h"
+#include "avl_tree.h"
+#include "balanced_build.h"
+#include "batch_balance.h"
+#include "tree_file.h"
+#include "stream_balance.h"
+#include "generic_balance.h"
+#include "tree_stats.h"
+#include "prefetch_balance.h"
+using namespace std;
+
+// Runs fn `reps` times and returns the fastest wall-clock time in milliseconds
+template <typename Fn>
+double bestOf(int reps, Fn fn) {
+    double best = 0;
+    for (int r = 0; r < reps; r++) {
+        auto start = chrono::steady_clock::now();
+        fn();
+        auto stop = chrono::steady_clock::now();
+        double ms = chrono::duration<double, milli>(stop - start).count();
+        if (r == 0 || ms < best) best = ms;
+    }
+    return best;
+}
+
+// Current resident set size in MiB, read from /proc/self/statm
+double residentMiB() {
+    ifstream statm("/proc/self/statm");
+    long pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * (double)sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0);
+}
+
+// Heap-backed node source, used where a benchmark is generic over allocators
+struct HeapNodes {
+    Node* make(int data) { return createNode(data); }
+    void destroy(Node* root) { deleteTree(root); }
+};
+
+struct ArenaNodes {
+    NodeArena arena;
+    Node* make(int data) { return createNode(arena, data); }
+    // The arena backs only this tree, so rewinding it frees exactly root
+    void destroy(Node*) { arena.reset(); }
+};
+
+// Perfect tree with 2^height - 1 nodes, built level by level
+template <typename Nodes>
+Node* buildPerfect(Nodes& nodes, int height) {
+    if (height <= 0) return nullptr;
+    vector<Node*> level(1, nodes.make(0));
+    Node* root = level[0];
+    for (int h = 1; h < height; h++) {
+        vector<Node*> next;
+        next.reserve(level.size() * 2);
+        for (size_t i = 0; i < level.size(); i++) {
+            level[i]->left = nodes.make(h);
+            level[i]->right = nodes.make(h);
+            next.push_back(level[i]->left);
+            next.push_back(level[i]->right);
+        }
+        level.swap(next);
+    }
+    return root;
+}
+
+Node* buildPerfect(int height) {
+    HeapNodes heap;
+    return buildPerfect(heap, height);
+}
+
+// Balanced tree over keys [lo, hi), allocated in pre-order the way a
+// top-down builder would lay it out
+template <typename Nodes>
+Node* buildMidpoint(Nodes& nodes, long lo, long hi) {
+    if (lo >= hi) return nullptr;
+    long mid = lo + (hi - lo) / 2;
+    Node* node = nodes.make(static_cast<int>(mid));
+    node->left = buildMidpoint(nodes, lo, mid);
+    node->right = buildMidpoint(nodes, mid + 1, hi);
+    return node;
+}
+
+// Left-leaning chain, the shape produced by inserting sorted keys
+Node* buildChain(int depth) {
+    if (depth <= 0) return nullptr;
+    Node* root = createNode(0);
+    Node* current = root;
+    for (int i = 1; i < depth; i++) {
+        current->left = createNode(i);
+        current = current->left;
+    }
+    return root;
+}
+
+int runRecursive(const Node* root) {
+    BalanceResult result = checkBalanceAndHeight(root, INT_MAX - 1);
+    return result.balanced ? result.height : -1;
+}
+
+// The recursive checker as it was before it returned BalanceResult: errors
+// were thrown and the wrapper printed them with endl. Kept here only as the
+// "before" side of the error-path latency benchmark.
+int legacyCheckBalanceAndHeight(const Node* root, bool& isBalanced, int maxDepth, int currentDepth) {
+    if (root == nullptr) return 0;
+    if (currentDepth > maxDepth) {
+        isBalanced = false;
+        throw overflow_error("Maximum depth exceeded, possible stack overflow.");
+    }
+    int leftHeight = legacyCheckBalanceAndHeight(root->left, isBalanced, maxDepth, currentDepth + 1);
+    if (!isBalanced) return 0;
+    int rightHeight = legacyCheckBalanceAndHeight(root->right, isBalanced, maxDepth, currentDepth + 1);
+    if (!isBalanced) return 0;
+    if (abs(leftHeight - rightHeight) > 1) isBalanced = false;
+    if (leftHeight > INT_MAX - 1 || rightHeight > INT_MAX - 1) {
+        isBalanced = false;
+        throw overflow_error("Height calculation overflow detected.");
+    }
+    return max(leftHeight, rightHeight) + 1;
+}
+
+bool legacyIsTreeBalanced(const Node* root, int maxDepth, ostream& log) {
+    bool isBalanced = true;
+    try {
+        legacyCheckBalanceAndHeight(root, isBalanced, maxDepth, 0);
+    } catch (const overflow_error& e) {
+        log << "Overflow error: " << e.what() << endl;
+        isBalanced = false;
+    }
+    return isBalanced;
+}
+
+void report(const char* shape, const char* engine, long nodes, double ms, int result) {
+    cout << left << setw(22) << shape << setw(12) << engine
+         << right << setw(12) << nodes << setw(12) << fixed << setprecision(3) << ms << " ms"
+         << setw(10) << setprecision(1) << (nodes / ms / 1000.0) << " Mnodes/s"
+         << "  result " << result << "\n";
+}
+
+// Recursive reference versus the iterative engine behind isTreeBalanced
+void benchIterative(int perfectHeight, int chainDepth) {
+    // The recursive checker needs one native frame per level; keep its chain
+    // well inside the default 8 MB stack.
+    int recursiveChainDepth = min(chainDepth, 50000);
+    const int reps = 5;
+
+    cout << "\n== recursive vs iterative balance check ==\n";
+    cout << left << setw(22) << "shape" << setw(12) << "engine"
+         << right << setw(12) << "nodes" << setw(15) << "best time" << setw(19) << "throughput" << "\n";
+
+    {
+        Node* root = buildPerfect(perfectHeight);
+        long nodes = (1L << perfectHeight) - 1;
+        int result = 0;
+        double ms = bestOf(reps, [&] { result = runRecursive(root); });
+        report("perfect", "recursive", nodes, ms, result);
+        BalanceStack scratch;
+        ms = bestOf(reps, [&] { result = checkBalanceIterative(root, scratch); });
+        report("perfect", "iterative", nodes, ms, result);
+        deleteTree(root);
+    }
+
+    {
+        Node* root = buildChain(recursiveChainDepth);
+        int result = 0;
+        double ms = bestOf(reps, [&] { result = runRecursive(root); });
+        report("chain (short)", "recursive", recursiveChainDepth, ms, result);
+        ms = bestOf(reps, [&] { result = checkBalanceIterative(root); });
+        report("chain (short)", "iterative", recursiveChainDepth, ms, result);
+        deleteTree(root);
+    }
+
+    {
+        Node* root = buildChain(chainDepth);
+        int result = 0;
+        double ms = bestOf(reps, [&] { result = checkBalanceIterative(root); });
+        report("chain (deep)", "iterative", chainDepth, ms, result);
+        deleteTree(root);
+    }
+}
+
+// Build, check and destroy one perfect tree, reporting each phase and the
+// resident memory the tree added
+template <typename Nodes>
+void benchAllocator(const char* name, int height) {
+    Nodes nodes;
+    double before = residentMiB();
+    auto t0 = chrono::steady_clock::now();
+    Node* root = buildPerfect(nodes, height);
+    auto t1 = chrono::steady_clock::now();
+    double after = residentMiB();
+    int result = checkBalanceIterative(root);
+    auto t2 = chrono::steady_clock::now();
+    nodes.destroy(root);
+    auto t3 = chrono::steady_clock::now();
+
+    typedef chrono::duration<double, milli> Ms;
+    cout << left << setw(10) << name << right << fixed << setprecision(1)
+         << setw(12) << Ms(t1 - t0).count() << " ms"
+         << setw(12) << Ms(t2 - t1).count() << " ms"
+         << setw(12) << Ms(t3 - t2).count() << " ms"
+         << setw(12) << (after - before) << " MiB"
+         << "  result " << result << "\n";
+}
+
+void benchArena(int height) {
+    cout << "\n== heap vs NodeArena, perfect tree with " << ((1L << height) - 1) << " nodes ==\n";
+    cout << left << setw(10) << "allocator" << right << setw(15) << "build" << setw(15) << "check"
+         << setw(15) << "destroy" << setw(16) << "RSS added" << "\n";
+    // Each allocator runs in a fresh child process so memory freed by one
+    // run cannot be recycled by the next and hide its footprint.
+    for (int mode = 0; mode < 2; mode++) {
+        cout.flush();
+        pid_t child = fork();
+        if (child == 0) {
+            if (mode == 0) benchAllocator<HeapNodes>("heap", height);
+            else benchAllocator<ArenaNodes>("arena", height);
+            cout.flush();
+            _exit(0);
+        }
+        waitpid(child, nullptr, 0);
+    }
+}
+
+// Pointer-based recursive check versus the FlatTree reverse sweep
+void benchFlat(long maxNodes) {
+    const int reps = 3;
+    cout << "\n== recursive pointer check vs FlatTree ==\n";
+    cout << left << setw(22) << "shape" << setw(12) << "engine"
+         << right << setw(12) << "nodes" << setw(15) << "best time" << setw(19) << "throughput" << "\n";
+    for (long n = 1000000; n <= maxNodes; n *= 10) {
+        ArenaNodes nodes;
+        Node* root = buildMidpoint(nodes, 0, n);
+        int result = 0;
+        double ms = bestOf(reps, [&] { result = runRecursive(root); });
+        report("midpoint", "recursive", n, ms, result);
+        ms = bestOf(reps, [&] { result = checkBalanceIterative(root); });
+        report("midpoint", "iterative", n, ms, result);
+
+        FlatTree flat;
+        auto t0 = chrono::steady_clock::now();
+        flattenTree(root, flat);
+        double convertMs = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+        nodes.destroy(root);
+        vector<uint8_t> heights;
+        ms = bestOf(reps, [&] { result = checkBalanceFlat(flat, heights); });
+        report("midpoint", "flat", n, ms, result);
+        cout << "  (conversion took " << fixed << setprecision(1) << convertMs << " ms)\n";
+    }
+}
+
+// Thread scaling of checkBalanceParallel on a balanced tree and on the same
+// tree made unbalanced at its far right edge, which exercises cancellation
+void benchParallel(long n, unsigned maxThreads) {
+    const int reps = 3;
+    ArenaNodes nodes;
+    Node* root = buildMidpoint(nodes, 0, n);
+
+    cout << "\n== parallel balance check, " << n << " nodes, forkDepth "
+         << ParallelBalanceOptions().forkDepth << " ==\n";
+    cout << left << setw(22) << "shape" << setw(12) << "threads"
+         << right << setw(12) << "nodes" << setw(15) << "best time" << setw(19) << "throughput" << "\n";
+
+    for (int skewed = 0; skewed < 2; skewed++) {
+        if (skewed) {
+            Node* current = root;
+            while (current->right != nullptr) current = current->right;
+            for (int i = 0; i < 3; i++) {
+                current->right = nodes.make(i);
+                current = current->right;
+            }
+        }
+        int result = 0;
+        double serialMs = bestOf(reps, [&] { result = checkBalanceIterative(root); });
+        report(skewed ? "skewed" : "balanced", "serial", n, serialMs, result);
+        for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+            ParallelBalanceOptions options;
+            options.threads = threads;
+            double ms = bestOf(reps, [&] { result = checkBalanceParallel(root, options); });
+            string label = to_string(threads);
+            report(skewed ? "skewed" : "balanced", label.c_str(), n, ms, result);
+        }
+    }
+}
+
+// Plain BST insert used as the baseline for the incremental benchmark
+void insertKey(Node*& root, int key) {
+    Node** link = &root;
+    while (*link != nullptr) {
+        if (key == (*link)->data) return;
+        link = key < (*link)->data ? &(*link)->left : &(*link)->right;
+    }
+    *link = createNode(key);
+}
+
+// Keys of a balanced BST over [0, n) in breadth-first order. Inserting them
+// in this order keeps the tree balanced after every single insert, which is
+// the worst case for a full recheck because it can never exit early.
+vector<int> levelOrderKeys(int n) {
+    vector<int> keys;
+    vector<pair<int, int> > ranges(1, make_pair(0, n));
+    for (size_t i = 0; i < ranges.size(); i++) {
+        int lo = ranges[i].first, hi = ranges[i].second;
+        if (lo >= hi) continue;
+        int mid = lo + (hi - lo) / 2;
+        keys.push_back(mid);
+        ranges.push_back(make_pair(lo, mid));
+        ranges.push_back(make_pair(mid + 1, hi));
+    }
+    return keys;
+}
+
+void reportOps(const char* engine, int operations, double ms, long balancedAnswers) {
+    cout << left << setw(22) << engine << right << setw(12) << operations
+         << setw(12) << fixed << setprecision(1) << ms << " ms"
+         << setw(12) << setprecision(3) << (operations / ms / 1000.0) << " Mops/s"
+         << "  balanced answers " << balancedAnswers << "\n";
+}
+
+// Mixed workload: every mutation is followed by a balance query. The
+// baseline answers by rechecking the whole tree; HeightTrackedTree answers
+// from the root's cached bit.
+void benchIncremental(int operations) {
+    cout << "\n== incremental balance tracking, mutation + query per op ==\n";
+    cout << left << setw(22) << "engine" << right << setw(12) << "ops"
+         << setw(15) << "time" << setw(19) << "throughput" << "\n";
+
+    // The full recheck is O(n) per query, so give it a smaller workload
+    int recheckOps = min(operations, 20000);
+    {
+        vector<int> keys = levelOrderKeys(recheckOps);
+        Node* root = nullptr;
+        long balancedAnswers = 0;
+        auto start = chrono::steady_clock::now();
+        for (int op = 0; op < recheckOps; op++) {
+            insertKey(root, keys[op]);
+            balancedAnswers += isTreeBalanced(root);
+        }
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        reportOps("full recheck", recheckOps, ms, balancedAnswers);
+        deleteTree(root);
+    }
+
+    {
+        vector<int> keys = levelOrderKeys(operations);
+        HeightTrackedTree tree;
+        long balancedAnswers = 0;
+        auto start = chrono::steady_clock::now();
+        for (int op = 0; op < operations; op++) {
+            tree.insert(keys[op]);
+            balancedAnswers += tree.isBalanced();
+        }
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        reportOps("tracked insert", operations, ms, balancedAnswers);
+
+        // Random erase/re-insert churn on the full tree
+        mt19937 rng(7);
+        balancedAnswers = 0;
+        start = chrono::steady_clock::now();
+        for (int op = 0; op < operations; op++) {
+            int key = static_cast<int>(rng() % operations);
+            if (!tree.erase(key)) tree.insert(key);
+            balancedAnswers += tree.isBalanced();
+        }
+        ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        reportOps("tracked erase/insert", operations, ms, balancedAnswers);
+    }
+}
+
+// AvlTree stores bare keys; the std::map baseline maps each key to 0
+inline void insertKey(AvlTree& tree, int key) { tree.insert(key); }
+inline void insertKey(map<int, int>& tree, int key) { tree.insert(make_pair(key, 0)); }
+
+// Insert throughput and lookup latency of AvlTree against std::map, for
+// random and for sorted key streams
+template <typename Tree>
+void benchOrderedSet(const char* name, const char* order, const vector<int>& keys,
+                     const vector<int>& probes) {
+    Tree tree;
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < keys.size(); i++) insertKey(tree, keys[i]);
+    double insertMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    long found = 0;
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < probes.size(); i++) found += tree.find(probes[i]) != tree.end();
+    double findMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    cout << left << setw(12) << name << setw(10) << order << right << setw(12) << keys.size()
+         << setw(12) << fixed << setprecision(3) << (keys.size() / insertMs / 1000.0) << " Mins/s"
+         << setw(12) << setprecision(1) << (findMs * 1e6 / probes.size()) << " ns/find"
+         << "  found " << found << "\n";
+}
+
+void benchAvl(int n) {
+    mt19937 rng(11);
+    vector<int> sorted(n);
+    for (int i = 0; i < n; i++) sorted[i] = i * 2;
+    vector<int> shuffled(sorted);
+    shuffle(shuffled.begin(), shuffled.end(), rng);
+    // Half the probes hit (even keys), half miss (odd keys)
+    vector<int> probes(n);
+    for (int i = 0; i < n; i++) probes[i] = static_cast<int>(rng() % (2u * n));
+
+    cout << "\n== AvlTree vs std::map ==\n";
+    cout << left << setw(12) << "container" << setw(10) << "keys" << right << setw(12) << "count"
+         << setw(19) << "insert" << setw(20) << "lookup" << "\n";
+    benchOrderedSet<AvlTree>("AvlTree", "random", shuffled, probes);
+    benchOrderedSet<map<int, int> >("std::map", "random", shuffled, probes);
+    benchOrderedSet<AvlTree>("AvlTree", "sorted", sorted, probes);
+    benchOrderedSet<map<int, int> >("std::map", "sorted", sorted, probes);
+}
+
+double elapsedMs(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// O(n) bulk load and DSW rebalancing against building by insertion
+void benchBulk(long maxKeys) {
+    cout << "\n== bulk load and rebalance ==\n";
+    cout << left << setw(34) << "operation" << right << setw(12) << "keys"
+         << setw(15) << "time" << setw(19) << "throughput" << "  (result = height)\n";
+    for (long n = 1000000; n <= maxKeys; n *= 10) {
+        vector<int> keys(n);
+        for (long i = 0; i < n; i++) keys[i] = static_cast<int>(i);
+
+        auto start = chrono::steady_clock::now();
+        Node* root = buildBalanced(keys.data(), keys.size());
+        double ms = elapsedMs(start);
+        report("buildBalanced", "(O(n))", n, ms, checkBalanceIterative(root));
+        deleteBalancedTree(root);
+
+        // Node-by-node insertion into a self-balancing tree costs O(n log n)
+        if (n <= 10000000) {
+            AvlTree tree;
+            start = chrono::steady_clock::now();
+            for (long i = 0; i < n; i++) tree.insert(keys[i]);
+            ms = elapsedMs(start);
+            report("AvlTree inserts", "(n log n)", n, ms, tree.height());
+        }
+
+        // The left chain that sorted inserts into a plain BST produce
+        {
+            NodeArena arena;
+            Node* chain = nullptr;
+            for (long i = 0; i < n; i++) {
+                Node* node = createNode(arena, keys[i]);
+                node->left = chain;
+                chain = node;
+            }
+            start = chrono::steady_clock::now();
+            chain = rebalance(chain);
+            ms = elapsedMs(start);
+            report("rebalance", "chain", n, ms, checkBalanceIterative(chain));
+
+            start = chrono::steady_clock::now();
+            chain = rebalance(chain);
+            ms = elapsedMs(start);
+            report("rebalance", "balanced", n, ms, checkBalanceIterative(chain));
+        }
+    }
+}
+
+// Many small random-BST trees validated one call at a time versus through
+// BatchBalanceValidator
+void benchBatch(long trees, unsigned maxThreads) {
+    const int reps = 5;
+    mt19937 rng(13);
+    NodeArena arena;
+    vector<const Node*> roots(trees);
+    long totalNodes = 0;
+    for (long t = 0; t < trees; t++) {
+        Node* root = nullptr;
+        int size = 15 + static_cast<int>(rng() % 49);
+        for (int i = 0; i < size; i++) {
+            int key = static_cast<int>(rng() % 1024);
+            Node** link = &root;
+            while (*link != nullptr && (*link)->data != key) {
+                link = key < (*link)->data ? &(*link)->left : &(*link)->right;
+            }
+            if (*link == nullptr) *link = createNode(arena, key);
+        }
+        // Straighten every other tree so about half the batch passes
+        roots[t] = t % 2 ? rebalance(root) : root;
+        totalNodes += size;
+    }
+
+    cout << "\n== batch validation of " << trees << " small trees ==\n";
+    cout << left << setw(22) << "engine" << setw(12) << "threads" << right << setw(12) << "nodes"
+         << setw(15) << "best time" << setw(19) << "throughput" << "\n";
+    // result = number of balanced trees
+    size_t balanced = 0;
+    double ms = bestOf(reps, [&] {
+        balanced = 0;
+        for (long t = 0; t < trees; t++) balanced += runRecursive(roots[t]) != -1;
+    });
+    report("recursive", "1", totalNodes, ms, static_cast<int>(balanced));
+    ms = bestOf(reps, [&] {
+        balanced = 0;
+        for (long t = 0; t < trees; t++) balanced += isTreeBalanced(roots[t]);
+    });
+    report("isTreeBalanced loop", "1", totalNodes, ms, static_cast<int>(balanced));
+
+    vector<uint64_t> bits((trees + 63) / 64);
+    vector<BalanceError> errors(trees);
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        BatchBalanceValidator validator(threads);
+        ms = bestOf(reps, [&] {
+            balanced = validator.validate(roots.data(), trees, bits.data(), errors.data());
+        });
+        string label = to_string(threads);
+        report("batch", label.c_str(), totalNodes, ms, static_cast<int>(balanced));
+    }
+}
+
+// Per-call latency percentiles of fn over `calls` calls, in nanoseconds
+template <typename Fn>
+void reportLatency(const char* path, const char* engine, int calls, Fn fn) {
+    vector<double> samples(calls);
+    for (int i = 0; i < calls; i++) {
+        auto start = chrono::steady_clock::now();
+        fn();
+        samples[i] = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+    }
+    sort(samples.begin(), samples.end());
+    cout << left << setw(10) << path << setw(26) << engine << right << fixed << setprecision(0)
+         << setw(10) << samples[calls / 2] << " ns" << setw(10) << samples[calls * 99 / 100] << " ns"
+         << setw(10) << samples[calls * 999 / 1000] << " ns\n";
+}
+
+void countBalanceError(BalanceError, const char*, void* context) {
+    ++*static_cast<long*>(context);
+}
+
+// Latency of the recursive checker before and after it switched from
+// exceptions plus endl-flushed printing to BalanceResult and a log callback.
+// "ok" checks a 63-node perfect tree; "error" checks a 64-deep chain against
+// maxDepth 32, which fails with DepthLimitExceeded.
+void benchErrors(int calls) {
+    Node* perfect = buildPerfect(6);
+    Node* chain = buildChain(64);
+    const int maxDepth = 32;
+    // Legacy output went to the console; /dev/null keeps the flush syscall
+    // without flooding the terminal.
+    ofstream devNull("/dev/null");
+    long logged = 0;
+    volatile bool sink = false;
+
+    cout << "\n== recursive checker latency per call ==\n";
+    cout << left << setw(10) << "path" << setw(26) << "engine" << right << setw(13) << "p50"
+         << setw(13) << "p99" << setw(13) << "p99.9" << "\n";
+    reportLatency("ok", "throw + endl (before)", calls, [&] {
+        sink = legacyIsTreeBalanced(perfect, maxDepth, devNull);
+    });
+    reportLatency("ok", "BalanceResult (after)", calls, [&] {
+        sink = checkBalanceAndHeight(perfect, maxDepth).balanced;
+    });
+    reportLatency("error", "throw + endl (before)", calls, [&] {
+        sink = legacyIsTreeBalanced(chain, maxDepth, devNull);
+    });
+    setBalanceLogger(nullptr);
+    reportLatency("error", "BalanceResult (after)", calls, [&] {
+        sink = checkBalanceAndHeight(chain, maxDepth).balanced;
+    });
+    setBalanceLogger(countBalanceError, &logged);
+    reportLatency("error", "BalanceResult + callback", calls, [&] {
+        sink = checkBalanceAndHeight(chain, maxDepth).balanced;
+    });
+    setBalanceLogger(nullptr);
+    (void)sink;
+    deleteTree(perfect);
+    deleteTree(chain);
+}
+
+// Runs fn in a fresh child process and waits for it, so each measurement
+// starts from an empty heap
+template <typename Fn>
+void inChild(Fn fn) {
+    cout.flush();
+    pid_t child = fork();
+    if (child == 0) {
+        fn();
+        cout.flush();
+        _exit(0);
+    }
+    waitpid(child, nullptr, 0);
+}
+
+// Process start-up cost: rebuilding a tree with createNode and checking it,
+// versus mapping a tree file and checking the mapped structure. The file's
+// pages are dropped from the page cache first for the cold run.
+void benchFile(long n, const char* path) {
+    {
+        HeapNodes heap;
+        Node* root = buildMidpoint(heap, 0, n);
+        if (!writeTreeFile(root, path)) {
+            cout << "\ncould not write " << path << "\n";
+            deleteTree(root);
+            return;
+        }
+        deleteTree(root);
+    }
+    struct stat info;
+    stat(path, &info);
+
+    cout << "\n== cold start, " << n << " nodes, tree file " << fixed << setprecision(1)
+         << info.st_size / (1024.0 * 1024.0) << " MiB ==\n";
+    cout << left << setw(22) << "start-up" << setw(12) << "phase" << right << setw(12) << "nodes"
+         << setw(15) << "time" << setw(19) << "throughput" << "\n";
+
+    inChild([&] {
+        HeapNodes heap;
+        auto start = chrono::steady_clock::now();
+        Node* root = buildMidpoint(heap, 0, n);
+        double buildMs = elapsedMs(start);
+        int result = checkBalanceIterative(root);
+        double totalMs = elapsedMs(start);
+        report("rebuild + check", "build", n, buildMs, result);
+        report("rebuild + check", "total", n, totalMs, result);
+    });
+
+    for (int warm = 0; warm < 2; warm++) {
+        inChild([&] {
+            if (!warm) {
+                int fd = open(path, O_RDONLY);
+                posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+                close(fd);
+            }
+            auto start = chrono::steady_clock::now();
+            MappedTree mapped;
+            mapped.open(path);
+            double openMs = elapsedMs(start);
+            int result = checkBalanceMapped(mapped);
+            double totalMs = elapsedMs(start);
+            const char* label = warm ? "mmap + check (warm)" : "mmap + check (cold)";
+            report(label, "open", n, openMs, result);
+            report(label, "total", n, totalMs, result);
+        });
+    }
+    remove(path);
+}
+
+// Writes the pre-order token stream of a balanced tree over keys [lo, hi)
+// straight to out, without building it. Recursion depth is O(log n).
+void writeMidpointTokens(FILE* out, long lo, long hi) {
+    if (lo >= hi) {
+        fputs("# ", out);
+        return;
+    }
+    long mid = lo + (hi - lo) / 2;
+    fprintf(out, "%ld ", mid);
+    writeMidpointTokens(out, lo, mid);
+    writeMidpointTokens(out, mid + 1, hi);
+}
+
+void reportStream(const char* source, const StreamingBalanceValidator& validator, double ms, int result) {
+    cout << left << setw(22) << source << right << setw(12) << validator.nodes()
+         << setw(12) << fixed << setprecision(1) << ms << " ms"
+         << setw(10) << (validator.nodes() / ms / 1000.0) << " Mnodes/s"
+         << setw(8) << setprecision(2) << (validator.bytes() / ms / 1e6) << " GB/s"
+         << "  result " << result << "\n";
+}
+
+// Streaming validation throughput over a generated token file, read through
+// a file descriptor and, separately, from memory in 1 MiB chunks
+void benchStream(long n, const char* path) {
+    FILE* out = fopen(path, "w");
+    if (out == nullptr) {
+        cout << "\ncould not write " << path << "\n";
+        return;
+    }
+    writeMidpointTokens(out, 0, n);
+    fclose(out);
+    struct stat info;
+    stat(path, &info);
+
+    cout << "\n== streaming validation, " << n << " nodes, " << fixed << setprecision(2)
+         << info.st_size / 1e9 << " GB of tokens ==\n";
+    cout << left << setw(22) << "source" << right << setw(12) << "nodes" << setw(15) << "time"
+         << setw(19) << "throughput" << setw(13) << "bandwidth" << "\n";
+
+    StreamingBalanceValidator validator;
+    for (int pass = 0; pass < 2; pass++) {
+        int fd = open(path, O_RDONLY);
+        if (pass == 0) posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        auto start = chrono::steady_clock::now();
+        int result = validateBalanceStream(fd, validator);
+        double ms = elapsedMs(start);
+        close(fd);
+        reportStream(pass == 0 ? "fd (cold cache)" : "fd (warm cache)", validator, ms, result);
+    }
+
+    // Parsing cost alone, when the whole stream fits in memory
+    if (info.st_size <= (1L << 31)) {
+        vector<char> text(info.st_size);
+        FILE* in = fopen(path, "r");
+        size_t got = fread(text.data(), 1, text.size(), in);
+        fclose(in);
+        validator.reset();
+        auto start = chrono::steady_clock::now();
+        const size_t chunk = 1 << 20;
+        for (size_t i = 0; i < got; i += chunk) {
+            if (!validator.feed(text.data() + i, min(chunk, got - i))) break;
+        }
+        int result = validator.finish();
+        reportStream("memory, 1 MiB chunks", validator, elapsedMs(start), result);
+    }
+    remove(path);
+}
+
+// Node layout and checker of is_balanced_r2.cpp
+struct TreeNode {
+    int val;
+    TreeNode* left;
+    TreeNode* right;
+    TreeNode(int x) : val(x), left(NULL), right(NULL) {}
+};
+
+int r2Check(const TreeNode* node) {
+    if (node == NULL) return 0;
+    int leftHeight = r2Check(node->left);
+    if (leftHeight == -1) return -1;
+    int rightHeight = r2Check(node->right);
+    if (rightHeight == -1) return -1;
+    if (abs(leftHeight - rightHeight) > 1) return -1;
+    return 1 + max(leftHeight, rightHeight);
+}
+
+// Same shape as a Node tree; recursion is fine for the perfect trees and the
+// shallow suite cases used here
+TreeNode* copyAsTreeNode(const Node* node) {
+    if (node == nullptr) return NULL;
+    TreeNode* copy = new TreeNode(node->data);
+    copy->left = copyAsTreeNode(node->left);
+    copy->right = copyAsTreeNode(node->right);
+    return copy;
+}
+
+void deleteTreeNodes(TreeNode* node) {
+    if (node == NULL) return;
+    deleteTreeNodes(node->left);
+    deleteTreeNodes(node->right);
+    delete node;
+}
+
+// checkBalanceGeneric instantiated per layout against the hand-written
+// checker for that layout
+void benchGeneric(int height) {
+    const int reps = 5;
+    long nodes = (1L << height) - 1;
+
+    cout << "\n== generic vs hand-specialised checkers ==\n";
+    cout << left << setw(22) << "layout" << setw(12) << "engine"
+         << right << setw(12) << "nodes" << setw(15) << "best time" << setw(19) << "throughput" << "\n";
+
+    Node* root = buildPerfect(height);
+    int result = 0;
+    BalanceStack scratch;
+    double ms = bestOf(reps, [&] { result = checkBalanceIterative(root, scratch); });
+    report("Node", "hand", nodes, ms, result);
+    GenericBalanceStack<PointerNodeTraits<Node>> nodeStack;
+    ms = bestOf(reps, [&] { result = checkBalanceGeneric<PointerNodeTraits<Node>>(root, nodeStack); });
+    report("Node", "generic", nodes, ms, result);
+
+    TreeNode* treeNodes = copyAsTreeNode(root);
+    ms = bestOf(reps, [&] { result = r2Check(treeNodes); });
+    report("TreeNode", "r2 check", nodes, ms, result);
+    GenericBalanceStack<PointerNodeTraits<TreeNode>> treeNodeStack;
+    ms = bestOf(reps, [&] { result = checkBalanceGeneric<PointerNodeTraits<TreeNode>>(treeNodes, treeNodeStack); });
+    report("TreeNode", "generic", nodes, ms, result);
+    deleteTreeNodes(treeNodes);
+
+    FlatTree flat;
+    flattenTree(root, flat);
+    vector<uint8_t> heights;
+    ms = bestOf(reps, [&] { result = checkBalanceFlat(flat, heights); });
+    report("FlatTree", "flat sweep", nodes, ms, result);
+    GenericBalanceStack<FlatTreeTraits> flatStack;
+    ms = bestOf(reps, [&] { result = checkBalanceGeneric<FlatTreeTraits>(0, flatStack, FlatTreeTraits(flat)); });
+    report("FlatTree", "generic", nodes, ms, result);
+    deleteTree(root);
+}
+
+// The checker of is_balanced_r1.cpp, returning the height or -1 instead of
+// a bool and an out parameter
+int r1Check(const Node* node) {
+    if (node == nullptr) return 0;
+    int leftHeight = r1Check(node->left);
+    if (leftHeight < 0) return -1;
+    int rightHeight = r1Check(node->right);
+    if (rightHeight < 0) return -1;
+    if (abs(leftHeight - rightHeight) > 1) return -1;
+    return max(leftHeight, rightHeight) + 1;
+}
+
+// The diagnosis of is_balanced_r1.cpp: one recursive pass per statistic
+int r1Height(const Node* node) {
+    return node == nullptr ? 0 : max(r1Height(node->left), r1Height(node->right)) + 1;
+}
+
+long r1Count(const Node* node) {
+    return node == nullptr ? 0 : r1Count(node->left) + r1Count(node->right) + 1;
+}
+
+int r1MinLeafDepth(const Node* node) {
+    if (node->left == nullptr && node->right == nullptr) return 0;
+    if (node->left == nullptr) return r1MinLeafDepth(node->right) + 1;
+    if (node->right == nullptr) return r1MinLeafDepth(node->left) + 1;
+    return min(r1MinLeafDepth(node->left), r1MinLeafDepth(node->right)) + 1;
+}
+
+// analyzeTree in both modes against a plain balance check and against one
+// recursive pass per statistic
+void benchStats(int height, int chainDepth) {
+    const int reps = 5;
+    cout << "\n== single-pass tree statistics ==\n";
+    cout << left << setw(22) << "shape" << setw(12) << "engine"
+         << right << setw(12) << "nodes" << setw(15) << "best time" << setw(19) << "throughput" << "\n";
+
+    Node* root = buildPerfect(height);
+    long nodes = (1L << height) - 1;
+    int result = 0;
+    BalanceStack scratch;
+    TreeStats stats;
+    double ms = bestOf(reps, [&] { result = checkBalanceIterative(root, scratch); });
+    report("perfect", "check only", nodes, ms, result);
+    ms = bestOf(reps, [&] { analyzeTree(root, stats, scratch, TreeStatsMode::BalancedOnly); result = stats.height; });
+    report("perfect", "stats fast", nodes, ms, result);
+    ms = bestOf(reps, [&] { analyzeTree(root, stats, scratch); result = stats.height; });
+    report("perfect", "stats full", nodes, ms, result);
+    volatile long sink = 0;
+    ms = bestOf(reps, [&] {
+        result = r1Height(root);
+        sink = r1Count(root) + r1MinLeafDepth(root);
+    });
+    report("perfect", "3 passes", nodes, ms, result);
+    deleteTree(root);
+
+    // An unbalanced tree, where the fast mode has to fall back to the full pass
+    root = buildChain(chainDepth);
+    ms = bestOf(reps, [&] { result = checkBalanceIterative(root, scratch); });
+    report("chain", "check only", chainDepth, ms, result);
+    ms = bestOf(reps, [&] { analyzeTree(root, stats, scratch, TreeStatsMode::BalancedOnly); result = stats.height; });
+    report("chain", "stats fast", chainDepth, ms, result);
+    ms = bestOf(reps, [&] { analyzeTree(root, stats, scratch); result = stats.height; });
+    report("chain", "stats full", chainDepth, ms, result);
+    deleteTree(root);
+}
+
+// Hardware event counter for the calling thread, read with perf_event_open.
+// valid() is false where the kernel or container does not allow it.
+class PerfCounter {
+public:
+    PerfCounter(uint32_t type, uint64_t config) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+    ~PerfCounter() { if (fd_ >= 0) close(fd_); }
+
+    bool valid() const { return fd_ >= 0; }
+
+    void start() {
+        if (fd_ < 0) return;
+        ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    uint64_t stop() {
+        uint64_t count = 0;
+        if (fd_ < 0) return 0;
+        ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd_, &count, sizeof(count)) != sizeof(count)) return 0;
+        return count;
+    }
+
+private:
+    int fd_;
+};
+
+// Perfect tree whose nodes sit at random positions in one pool, so that
+// nearly every child pointer leads to a different cache line
+Node* buildScattered(vector<Node>& pool, int height) {
+    size_t n = (size_t(1) << height) - 1;
+    pool.assign(n, Node());
+    vector<uint32_t> slot(n);
+    for (size_t i = 0; i < n; i++) slot[i] = static_cast<uint32_t>(i);
+    shuffle(slot.begin(), slot.end(), mt19937(7));
+    // Breadth-first index i has children 2i + 1 and 2i + 2
+    for (size_t i = 0; i < n; i++) {
+        Node& node = pool[slot[i]];
+        node.data = static_cast<int>(i);
+        node.left = 2 * i + 1 < n ? &pool[slot[2 * i + 1]] : nullptr;
+        node.right = 2 * i + 2 < n ? &pool[slot[2 * i + 2]] : nullptr;
+    }
+    return &pool[slot[0]];
+}
+
+// Latency-hiding engines on a cache-hostile tree, with last-level cache
+// misses from perf_event_open where available
+void benchPrefetch(int height) {
+    const int reps = 3;
+    vector<Node> pool;
+    Node* root = buildScattered(pool, height);
+    long nodes = static_cast<long>(pool.size());
+    PerfCounter misses(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+
+    cout << "\n== prefetching traversal, " << nodes << " scattered nodes ==\n";
+    if (!misses.valid()) cout << "(perf_event_open unavailable: LLC misses not reported)\n";
+    cout << left << setw(22) << "engine" << right << setw(12) << "nodes" << setw(15) << "best time"
+         << setw(19) << "throughput" << setw(16) << "LLC misses/node" << "\n";
+
+    auto run = [&](const char* engine, function<int()> check) {
+        int result = 0;
+        double ms = bestOf(reps, [&] { result = check(); });
+        misses.start();
+        check();
+        uint64_t count = misses.stop();
+        cout << left << setw(22) << engine << right << setw(12) << nodes
+             << setw(12) << fixed << setprecision(1) << ms << " ms"
+             << setw(10) << (nodes / ms / 1000.0) << " Mnodes/s";
+        if (misses.valid()) cout << setw(16) << setprecision(2) << double(count) / nodes;
+        else cout << setw(16) << "n/a";
+        cout << "  result " << result << "\n";
+    };
+
+    BalanceStack scratch;
+    run("recursive", [&] { return runRecursive(root); });
+    run("iterative", [&] { return checkBalanceIterative(root, scratch); });
+    run("prefetch", [&] { return checkBalancePrefetch(root, scratch); });
+    const unsigned lanes[] = { 4, 8, 16, 32 };
+    for (unsigned l : lanes) {
+        string engine = "interleaved x" + to_string(l);
+        run(engine.c_str(), [&] { return checkBalanceInterleaved(root, l); });
+    }
+}
+
+// Seed of the suite's generators. Each shape and size derives its own
+// stream from it, so any single case can be regenerated on its own.
+const uint64_t SUITE_SEED = 20240501;
+
+// Complete tree with n nodes (perfect when n = 2^h - 1), linked breadth-first
+Node* suitePerfect(ArenaNodes& nodes, long n, mt19937_64&) {
+    vector<Node*> order(n);
+    for (long i = 0; i < n; i++) order[i] = nodes.make(static_cast<int>(i));
+    for (long i = 0; i < n; i++) {
+        if (2 * i + 1 < n) order[i]->left = order[2 * i + 1];
+        if (2 * i + 2 < n) order[i]->right = order[2 * i + 2];
+    }
+    return n > 0 ? order[0] : nullptr;
+}
+
+// FNV-1a, so per-shape seeds do not depend on the standard library
+uint64_t suiteHash(const char* name) {
+    uint64_t hash = 14695981039346656037ull;
+    for (; *name != '\0'; name++) hash = (hash ^ static_cast<unsigned char>(*name)) * 1099511628211ull;
+    return hash;
+}
+
+// BST built by inserting a seeded shuffle of [0, n). The Fisher-Yates loop
+// is written out because std::shuffle's draws differ between libraries.
+Node* suiteRandomBst(ArenaNodes& nodes, long n, mt19937_64& rng) {
+    vector<int> keys(n);
+    for (long i = 0; i < n; i++) keys[i] = static_cast<int>(i);
+    for (long i = n - 1; i > 0; i--) swap(keys[i], keys[rng() % static_cast<uint64_t>(i + 1)]);
+    Node* root = nullptr;
+    for (long i = 0; i < n; i++) {
+        Node** link = &root;
+        while (*link != nullptr) link = keys[i] < (*link)->data ? &(*link)->left : &(*link)->right;
+        *link = nodes.make(keys[i]);
+    }
+    return root;
+}
+
+// Fibonacci tree: the AVL tree of the given height with the fewest nodes,
+// where every inner node's subtrees differ in height by exactly one
+Node* buildFibonacci(ArenaNodes& nodes, int height, int& nextKey) {
+    if (height <= 0) return nullptr;
+    Node* left = buildFibonacci(nodes, height - 1, nextKey);
+    Node* node = nodes.make(nextKey++);
+    node->left = left;
+    node->right = buildFibonacci(nodes, height - 2, nextKey);
+    return node;
+}
+
+// Largest Fibonacci tree with at most n nodes
+Node* suiteFibonacci(ArenaNodes& nodes, long n, mt19937_64&) {
+    long sizes[3] = { 0, 1, 0 };
+    int height = n > 0 ? 1 : 0;
+    while ((sizes[2] = sizes[1] + sizes[0] + 1) <= n) {
+        sizes[0] = sizes[1];
+        sizes[1] = sizes[2];
+        height++;
+    }
+    int nextKey = 0;
+    return buildFibonacci(nodes, height, nextKey);
+}
+
+Node* suiteChain(ArenaNodes& nodes, long n, bool zigZag) {
+    if (n <= 0) return nullptr;
+    Node* root = nodes.make(0);
+    Node* current = root;
+    for (long i = 1; i < n; i++) {
+        Node* node = nodes.make(static_cast<int>(i));
+        if (zigZag && i % 2) current->right = node; else current->left = node;
+        current = node;
+    }
+    return root;
+}
+
+Node* suiteLeftChain(ArenaNodes& nodes, long n, mt19937_64&) { return suiteChain(nodes, n, false); }
+Node* suiteZigZag(ArenaNodes& nodes, long n, mt19937_64&) { return suiteChain(nodes, n, true); }
+
+struct SuiteShape {
+    const char* name;
+    Node* (*build)(ArenaNodes&, long, mt19937_64&);
+    bool deep;  // height grows linearly with n
+};
+
+// Runs every in-memory checker on each shape at 10^3 .. maxNodes nodes and
+// writes the results as Google Benchmark-style JSON. The recursive checkers
+// (including those of is_balanced_r1.cpp and is_balanced_r2.cpp) are skipped
+// on chains deeper than they can handle, and the flat layout above 5e7
+// nodes to keep the largest case within ~3 GB.
+void benchSuite(long maxNodes, const char* jsonPath) {
+    const SuiteShape shapes[] = {
+        { "perfect", suitePerfect, false },
+        { "random_bst", suiteRandomBst, false },
+        { "fibonacci", suiteFibonacci, false },
+        { "left_chain", suiteLeftChain, true },
+        { "zig_zag", suiteZigZag, true },
+    };
+    struct Row {
+        string name;
+        long nodes;
+        double ms;
+        int result;
+    };
+    vector<Row> rows;
+
+    cout << "\n== benchmark suite, seed " << SUITE_SEED << ", up to " << maxNodes << " nodes ==\n";
+    cout << left << setw(22) << "shape" << setw(12) << "engine"
+         << right << setw(12) << "nodes" << setw(15) << "best time" << setw(19) << "throughput" << "\n";
+
+    for (const SuiteShape& shape : shapes) {
+        for (long n = 1000; n <= maxNodes; n *= 10) {
+            ArenaNodes nodes;
+            mt19937_64 rng(SUITE_SEED ^ suiteHash(shape.name) ^ static_cast<uint64_t>(n));
+            Node* root = shape.build(nodes, n, rng);
+            long count = static_cast<long>(nodes.arena.nodesAllocated());
+            int reps = count <= 100000 ? 20 : count <= 10000000 ? 5 : 3;
+
+            auto run = [&](const char* engine, function<int()> check) {
+                int result = 0;
+                double ms = bestOf(reps, [&] { result = check(); });
+                report(shape.name, engine, count, ms, result);
+                Row row = { string(shape.name) + "/" + to_string(count) + "/" + engine, count, ms, result };
+                rows.push_back(row);
+            };
+
+            BalanceStack scratch;
+            GenericBalanceStack<PointerNodeTraits<Node>> genericStack;
+            TreeStats stats;
+            // The recursive checkers, including the r1 and r2 ports, only
+            // run where their recursion depth is safe
+            bool shallow = !shape.deep || count <= 50000;
+            if (shallow) {
+                run("recursive", [&] { return runRecursive(root); });
+                run("r1", [&] { return r1Check(root); });
+                TreeNode* treeNodes = copyAsTreeNode(root);
+                run("r2", [&] { return r2Check(treeNodes); });
+                deleteTreeNodes(treeNodes);
+            }
+            run("iterative", [&] { return checkBalanceIterative(root, scratch); });
+            run("generic", [&] { return checkBalanceGeneric<PointerNodeTraits<Node>>(root, genericStack); });
+            run("prefetch", [&] { return checkBalancePrefetch(root, scratch); });
+            run("interleaved", [&] { return checkBalanceInterleaved(root); });
+            run("parallel", [&] { return checkBalanceParallel(root, ParallelBalanceOptions()); });
+            run("stats_fast", [&] {
+                BalanceError error = analyzeTree(root, stats, scratch, TreeStatsMode::BalancedOnly);
+                return error == BalanceError::None ? stats.height : HEIGHT_UNBALANCED;
+            });
+            if (count <= 50000000) {
+                FlatTree flat;
+                flattenTree(root, flat);
+                vector<uint8_t> heights;
+                run("flat", [&] { return checkBalanceFlat(flat, heights); });
+            }
+        }
+    }
+
+    ofstream json(jsonPath);
+    json << "{\n  \"context\": {\n"
+         << "    \"executable\": \"bench_balanced_tree\",\n"
+         << "    \"seed\": " << SUITE_SEED << ",\n"
+         << "    \"max_nodes\": " << maxNodes << ",\n"
+         << "    \"num_cpus\": " << thread::hardware_concurrency() << ",\n"
+         << "    \"compiler\": \"" << __VERSION__ << "\",\n"
+#ifdef NDEBUG
+         << "    \"library_build_type\": \"release\"\n"
+#else
+         << "    \"library_build_type\": \"debug\"\n"
+#endif
+         << "  },\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < rows.size(); i++) {
+        const Row& row = rows[i];
+        json << "    {\"name\": \"" << row.name << "\", \"run_type\": \"iteration\", "
+             << "\"real_time\": " << fixed << setprecision(6) << row.ms << ", \"time_unit\": \"ms\", "
+             << "\"items_per_second\": " << setprecision(0) << (row.nodes / row.ms * 1000.0) << ", "
+             << "\"nodes\": " << row.nodes << ", \"result\": " << row.result << "}"
+             << (i + 1 < rows.size() ? "," : "") << "\n";
+    }
+    json << "  ]\n}\n";
+    cout << (json ? "wrote " : "could not write ") << jsonPath << "\n";
+}
+
+int main(int argc, char** argv) {
+    string section = argc > 1 ? argv[1] : "all";
+    int height = argc > 2 ? atoi(argv[2]) : 22;
+
+    if (section == "all" || section == "iterative") {
+        benchIterative(height, argc > 3 ? atoi(argv[3]) : 10000000);
+    }
+    if (section == "all" || section == "arena") {
+        benchArena(section == "arena" && argc > 2 ? height : 23);
+    }
+    if (section == "all" || section == "flat") {
+        benchFlat(section == "flat" && argc > 2 ? atol(argv[2]) : 10000000);
+    }
+    if (section == "all" || section == "parallel") {
+        unsigned cores = thread::hardware_concurrency();
+        benchParallel(section == "parallel" && argc > 2 ? atol(argv[2]) : 16000000,
+                      section == "parallel" && argc > 3 ? atoi(argv[3]) : (cores ? cores : 1));
+    }
+    if (section == "all" || section == "incremental") {
+        benchIncremental(section == "incremental" && argc > 2 ? atoi(argv[2]) : 1000000);
+    }
+    if (section == "all" || section == "avl") {
+        benchAvl(section == "avl" && argc > 2 ? atoi(argv[2]) : 1000000);
+    }
+    if (section == "all" || section == "bulk") {
+        benchBulk(section == "bulk" && argc > 2 ? atol(argv[2]) : 10000000);
+    }
+    if (section == "all" || section == "batch") {
+        unsigned cores = thread::hardware_concurrency();
+        benchBatch(section == "batch" && argc > 2 ? atol(argv[2]) : 200000,
+                   section == "batch" && argc > 3 ? atoi(argv[3]) : (cores ? cores : 1));
+    }
+    if (section == "all" || section == "errors") {
+        benchErrors(section == "errors" && argc > 2 ? atoi(argv[2]) : 200000);
+    }
+    if (section == "all" || section == "file") {
+        benchFile(section == "file" && argc > 2 ? atol(argv[2]) : 10000000,
+                  section == "file" && argc > 3 ? argv[3] : "/tmp/bench_balanced_tree.tree");
+    }
+    if (section == "all" || section == "stream") {
+        benchStream(section == "stream" && argc > 2 ? atol(argv[2]) : 20000000,
+                    section == "stream" && argc > 3 ? argv[3] : "/tmp/bench_balanced_tree.tokens");
+    }
+    if (section == "all" || section == "generic") {
+        benchGeneric(section == "generic" && argc > 2 ? height : 22);
+    }
+    if (section == "all" || section == "stats") {
+        benchStats(section == "stats" && argc > 2 ? height : 22,
+                   section == "stats" && argc > 3 ? atoi(argv[3]) : 10000000);
+    }
+    if (section == "all" || section == "prefetch") {
+        benchPrefetch(section == "prefetch" && argc > 2 ? height : 24);
+    }
+    if (section == "all" || section == "suite") {
+        benchSuite(section == "suite" && argc > 2 ? atol(argv[2]) : 1000000,
+                   section == "suite" && argc > 3 ? argv[3] : "bench_balanced_tree.json");
+    }
+    return 0;
+}
@@ -0,0 +1,113 @@
+#ifndef FLAT_TREE_H
+#define FLAT_TREE_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "balanced_tree.h"
+
+// Index value marking a missing child in a FlatTree
+const uint32_t FLAT_TREE_NIL = 0xFFFFFFFFu;
+
+// Structure-of-arrays tree layout. Nodes are stored in breadth-first order
+// with the root at index 0, and children are referenced by 32-bit index
+// instead of by pointer. Every child has a larger index than its parent, so
+// a single reverse sweep visits children before parents.
+struct FlatTree {
+    std::vector<int32_t> data;
+    std::vector<uint32_t> left;
+    std::vector<uint32_t> right;
+
+    size_t size() const { return data.size(); }
+    bool empty() const { return data.empty(); }
+
+    void clear() {
+        data.clear();
+        left.clear();
+        right.clear();
+    }
+};
+
+// Index-based child access for the generic checker in generic_balance.h
+struct FlatTreeTraits {
+    typedef uint32_t Handle;
+
+    const uint32_t* leftChild;
+    const uint32_t* rightChild;
+
+    explicit FlatTreeTraits(const FlatTree& tree) : leftChild(tree.left.data()), rightChild(tree.right.data()) {}
+
+    Handle left(Handle node) const { return leftChild[node]; }
+    Handle right(Handle node) const { return rightChild[node]; }
+    bool isNull(Handle node) const { return node == FLAT_TREE_NIL; }
+};
+
+// Converts a pointer-based tree into breadth-first FlatTree order. Returns
+// false (leaving out empty) if the tree has too many nodes to be indexed
+// with 32 bits.
+inline bool flattenTree(const Node* root, FlatTree& out) {
+    out.clear();
+    if (root == nullptr) return true;
+
+    // The BFS queue doubles as the index -> Node map: a node's index is its
+    // position in `order`.
+    std::vector<const Node*> order;
+    order.push_back(root);
+    for (size_t i = 0; i < order.size(); i++) {
+        const Node* node = order[i];
+        if (order.size() + 2 > FLAT_TREE_NIL) {
+            out.clear();
+            return false;
+        }
+        out.data.push_back(node->data);
+        if (node->left != nullptr) {
+            out.left.push_back(static_cast<uint32_t>(order.size()));
+            order.push_back(node->left);
+        } else {
+            out.left.push_back(FLAT_TREE_NIL);
+        }
+        if (node->right != nullptr) {
+            out.right.push_back(static_cast<uint32_t>(order.size()));
+            order.push_back(node->right);
+        } else {
+            out.right.push_back(FLAT_TREE_NIL);
+        }
+    }
+    return true;
+}
+
+// Balance check over a FlatTree. Returns the height of the tree, or -1 if
+// any subtree is unbalanced. Heights are filled in by one reverse pass over
+// the index arrays; the caller may pass a scratch buffer to reuse across
+// calls.
+//
+// A height is only ever recorded for a subtree already proven balanced, and
+// a balanced tree indexable with 32 bits is at most ~46 levels high, so one
+// byte per node is enough.
+inline int checkBalanceFlat(const FlatTree& tree, std::vector<uint8_t>& heights) {
+    const size_t n = tree.size();
+    if (n == 0) return 0;
+    heights.resize(n);
+    const uint32_t* left = tree.left.data();
+    const uint32_t* right = tree.right.data();
+    uint8_t* h = heights.data();
+
+    for (size_t i = n; i-- > 0;) {
+        int leftHeight = left[i] == FLAT_TREE_NIL ? 0 : h[left[i]];
+        int rightHeight = right[i] == FLAT_TREE_NIL ? 0 : h[right[i]];
+        if (std::abs(leftHeight - rightHeight) > 1) return -1;
+        h[i] = static_cast<uint8_t>((leftHeight > rightHeight ? leftHeight : rightHeight) + 1);
+    }
+    return h[0];
+}
+
+inline int checkBalanceFlat(const FlatTree& tree) {
+    std::vector<uint8_t> heights;
+    return checkBalanceFlat(tree, heights);
+}
+
+inline bool isTreeBalanced(const FlatTree& tree) {
+    return checkBalanceFlat(tree) >= 0;
+}
+
+#endif // FLAT_TREE_H
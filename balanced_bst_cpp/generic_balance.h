@@ -0,0 +1,210 @@
+#ifndef GENERIC_BALANCE_H
+#define GENERIC_BALANCE_H
+
+#include <cstdlib>
+#include <algorithm>
+#include "balanced_tree.h"
+
+// Balance checking over any node layout. A traits type tells the checker how
+// to walk the tree:
+//
+//     struct Traits {
+//         typedef ... Handle;                 // cheap to copy: pointer, index, tagged word
+//         Handle left(Handle node) const;
+//         Handle right(Handle node) const;
+//         bool isNull(Handle node) const;
+//     };
+//
+// Traits are passed by value and may carry state (e.g. the arrays behind
+// index-based children). All calls are inlined, so an instantiation compiles
+// to the same loop as checkBalanceIterative. A visitor (see BalanceVisitor)
+// can observe each node, tolerate imbalance or pause the walk; analyzeTree
+// and the prefetching checkers are built that way.
+
+// Traits for nodes with `left` and `right` pointer members, such as Node and
+// the TreeNode of is_balanced_r2.cpp
+template <class NodeT>
+struct PointerNodeTraits {
+    typedef const NodeT* Handle;
+
+    Handle left(Handle node) const { return node->left; }
+    Handle right(Handle node) const { return node->right; }
+    bool isNull(Handle node) const { return node == nullptr; }
+};
+
+template <class Handle>
+struct GenericBalanceFrame {
+    Handle node;
+    int leftHeight;
+    bool leftDone;
+};
+
+// Node pointers keep using BalanceFrame, so walks over Node share a
+// BalanceStack with checkBalanceIterative
+template <class Handle>
+struct GenericBalanceFrameOf {
+    typedef GenericBalanceFrame<Handle> type;
+};
+
+template <>
+struct GenericBalanceFrameOf<const Node*> {
+    typedef BalanceFrame type;
+};
+
+template <class Traits>
+using GenericBalanceStack = BasicBalanceStack<typename GenericBalanceFrameOf<typename Traits::Handle>::type>;
+
+// Hooks called by the walk. This default observes nothing and stops at the
+// first node out of tolerance, which is a plain balance check. Visitors
+// derive from it and hide the hooks they need.
+struct BalanceVisitor {
+    // Every node, before its subtrees; depth is 0 at the root
+    template <class Handle>
+    void enter(Handle, size_t, bool) {}
+
+    // The walk is about to move to node, a child; true pauses it there
+    template <class Handle>
+    bool pauseAt(Handle) { return false; }
+
+    // A node whose subtree heights differ by more than the tolerance; true
+    // ends the walk with HEIGHT_UNBALANCED, false carries on
+    template <class Handle>
+    bool unbalanced(Handle, int) { return true; }
+};
+
+// Iterative post-order walk that can be paused and resumed. Tolerance is the
+// largest allowed difference between the heights of two sibling subtrees (1
+// for AVL balance). The frames live in a stack passed to each run(), so a
+// paused walk is a few words of state.
+template <class Traits, int Tolerance = 1, class Visitor = BalanceVisitor>
+class GenericBalanceWalk {
+public:
+    static_assert(Tolerance >= 0, "tolerance must not be negative");
+    typedef typename Traits::Handle Handle;
+
+    explicit GenericBalanceWalk(Traits traits = Traits(), Visitor visitor = Visitor())
+        : traits_(traits), visitor_(visitor), current_(), depth_(0), height_(0), descend_(false), done_(true) {}
+
+    void start(Handle root) {
+        current_ = root;
+        depth_ = 0;
+        height_ = 0;
+        descend_ = !traits_.isNull(root);
+        done_ = !descend_;
+    }
+
+    // Walks until the tree is done or the visitor pauses. stack must be the
+    // one passed to earlier runs since start().
+    void run(GenericBalanceStack<Traits>& stack) {
+        typedef typename GenericBalanceFrameOf<Handle>::type Frame;
+        if (done_) return;
+        if (!stack.reserve(64)) return finish(HEIGHT_OUT_OF_MEMORY);
+        const Traits traits = traits_;
+        Frame* frames = stack.data();
+        size_t capacity = stack.capacity();
+        size_t depth = depth_;
+        Handle current = current_;
+        bool descend = descend_;
+        int height;
+        for (;;) {
+            height = 0;
+            while (descend) {
+                Handle left = traits.left(current);
+                Handle right = traits.right(current);
+                bool leaf = traits.isNull(left) && traits.isNull(right);
+                visitor_.enter(current, depth, leaf);
+                if (leaf) {
+                    height = 1;
+                    break;
+                }
+                if (depth == capacity) {
+                    if (!stack.reserve(capacity + 1)) return finish(HEIGHT_OUT_OF_MEMORY);
+                    frames = stack.data();
+                    capacity = stack.capacity();
+                }
+                Frame& frame = frames[depth++];
+                frame.node = current;
+                frame.leftDone = false;
+                current = left;
+                descend = !traits.isNull(left);
+                if (descend && visitor_.pauseAt(current)) return pause(current, depth);
+            }
+            descend = false;
+
+            while (depth > 0) {
+                Frame& top = frames[depth - 1];
+                if (!top.leftDone) {
+                    top.leftDone = true;
+                    top.leftHeight = height;
+                    Handle right = traits.right(top.node);
+                    if (!traits.isNull(right)) {
+                        current = right;
+                        descend = true;
+                        break;
+                    }
+                    height = 0;
+                }
+                int imbalance = std::abs(top.leftHeight - height);
+                if (imbalance > Tolerance && visitor_.unbalanced(top.node, imbalance)) {
+                    return finish(HEIGHT_UNBALANCED);
+                }
+                height = std::max(top.leftHeight, height) + 1;
+                --depth;
+            }
+            if (!descend) return finish(height);
+            if (visitor_.pauseAt(current)) return pause(current, depth);
+        }
+    }
+
+    bool done() const { return done_; }
+
+    // Once done: the height, HEIGHT_UNBALANCED or HEIGHT_OUT_OF_MEMORY
+    int height() const { return height_; }
+
+    Visitor& visitor() { return visitor_; }
+
+private:
+    void pause(Handle current, size_t depth) {
+        current_ = current;
+        depth_ = depth;
+        descend_ = true;
+    }
+
+    void finish(int height) {
+        height_ = height;
+        done_ = true;
+    }
+
+    Traits traits_;
+    Visitor visitor_;
+    Handle current_;
+    size_t depth_;
+    int height_;
+    bool descend_;
+    bool done_;
+};
+
+// Checks the tree at root in one run of a GenericBalanceWalk. Returns the
+// height, HEIGHT_UNBALANCED or HEIGHT_OUT_OF_MEMORY, like
+// checkBalanceIterative.
+template <class Traits, int Tolerance = 1, class Visitor = BalanceVisitor>
+int checkBalanceGeneric(typename Traits::Handle root, GenericBalanceStack<Traits>& stack,
+                        Traits traits = Traits(), Visitor visitor = Visitor()) {
+    GenericBalanceWalk<Traits, Tolerance, Visitor> walk(traits, visitor);
+    walk.start(root);
+    walk.run(stack);
+    return walk.height();
+}
+
+template <class Traits, int Tolerance = 1>
+int checkBalanceGeneric(typename Traits::Handle root, Traits traits = Traits()) {
+    GenericBalanceStack<Traits> stack;
+    return checkBalanceGeneric<Traits, Tolerance>(root, stack, traits);
+}
+
+template <class Traits, int Tolerance = 1>
+bool is_balanced(typename Traits::Handle root, Traits traits = Traits()) {
+    return checkBalanceGeneric<Traits, Tolerance>(root, traits) >= 0;
+}
+
+#endif // GENERIC_BALANCE_H
@@ -0,0 +1,154 @@
+#ifndef HEIGHT_TRACKED_TREE_H
+#define HEIGHT_TRACKED_TREE_H
+
+#include <cstdlib>
+#include <algorithm>
+#include <new>
+#include <vector>
+#include "balanced_tree.h"
+
+// Node that carries its subtree height and whether that whole subtree is
+// balanced. The embedded Node comes first and its child pointers point at
+// the children's embedded Nodes, so a tracked tree is also an ordinary Node
+// tree and can be handed to any checker in balanced_tree.h.
+struct TrackedNode {
+    Node node;
+    TrackedNode* parent;
+    int height;
+    bool balanced;
+};
+
+inline TrackedNode* tracked(Node* node) {
+    return reinterpret_cast<TrackedNode*>(node);
+}
+
+inline const TrackedNode* tracked(const Node* node) {
+    return reinterpret_cast<const TrackedNode*>(node);
+}
+
+// Unbalanced binary search tree that keeps the answer to "is the tree
+// balanced?" up to date. Each insert or erase refreshes the cached height
+// and balanced bit only along the path from the changed node to the root,
+// stopping as soon as nothing changes, so queries are O(1) and updates cost
+// O(depth) - O(log n) while the tree stays balanced.
+class HeightTrackedTree {
+public:
+    HeightTrackedTree() : root_(nullptr), size_(0) {}
+    ~HeightTrackedTree() {
+        std::vector<TrackedNode*> pending;
+        if (root_ != nullptr) pending.push_back(root_);
+        while (!pending.empty()) {
+            TrackedNode* node = pending.back();
+            pending.pop_back();
+            if (node->node.left != nullptr) pending.push_back(tracked(node->node.left));
+            if (node->node.right != nullptr) pending.push_back(tracked(node->node.right));
+            delete node;
+        }
+    }
+
+    HeightTrackedTree(const HeightTrackedTree&) = delete;
+    HeightTrackedTree& operator=(const HeightTrackedTree&) = delete;
+
+    // Root as a plain Node tree, for the checkers in balanced_tree.h
+    Node* root() const { return root_ ? &root_->node : nullptr; }
+
+    size_t size() const { return size_; }
+    int height() const { return root_ ? root_->height : 0; }
+    bool isBalanced() const { return root_ == nullptr || root_->balanced; }
+
+    bool contains(int key) const {
+        const Node* current = root();
+        while (current != nullptr) {
+            if (key == current->data) return true;
+            current = key < current->data ? current->left : current->right;
+        }
+        return false;
+    }
+
+    // Inserts key; returns false if it was already present or allocation failed
+    bool insert(int key) {
+        TrackedNode* parent = nullptr;
+        Node* current = root();
+        while (current != nullptr) {
+            if (key == current->data) return false;
+            parent = tracked(current);
+            current = key < current->data ? current->left : current->right;
+        }
+        TrackedNode* created = new (std::nothrow) TrackedNode();
+        if (created == nullptr) return false;
+        created->node.data = key;
+        created->node.left = created->node.right = nullptr;
+        created->parent = parent;
+        created->height = 1;
+        created->balanced = true;
+        if (parent == nullptr) {
+            root_ = created;
+        } else if (key < parent->node.data) {
+            parent->node.left = &created->node;
+        } else {
+            parent->node.right = &created->node;
+        }
+        ++size_;
+        refreshPath(parent);
+        return true;
+    }
+
+    // Removes key; returns false if it was not present
+    bool erase(int key) {
+        Node* current = root();
+        while (current != nullptr && key != current->data) {
+            current = key < current->data ? current->left : current->right;
+        }
+        if (current == nullptr) return false;
+
+        // A node with two children takes its successor's key, and the
+        // successor (which has no left child) is unlinked instead.
+        TrackedNode* victim = tracked(current);
+        if (current->left != nullptr && current->right != nullptr) {
+            Node* successor = current->right;
+            while (successor->left != nullptr) successor = successor->left;
+            current->data = successor->data;
+            victim = tracked(successor);
+        }
+
+        Node* child = victim->node.left != nullptr ? victim->node.left : victim->node.right;
+        TrackedNode* parent = victim->parent;
+        if (child != nullptr) tracked(child)->parent = parent;
+        if (parent == nullptr) {
+            root_ = child ? tracked(child) : nullptr;
+        } else if (parent->node.left == &victim->node) {
+            parent->node.left = child;
+        } else {
+            parent->node.right = child;
+        }
+        delete victim;
+        --size_;
+        refreshPath(parent);
+        return true;
+    }
+
+private:
+    // Recomputes height and balance from node up to the root, stopping at
+    // the first ancestor whose cached values did not change.
+    void refreshPath(TrackedNode* node) {
+        while (node != nullptr) {
+            const TrackedNode* left = node->node.left ? tracked(node->node.left) : nullptr;
+            const TrackedNode* right = node->node.right ? tracked(node->node.right) : nullptr;
+            int leftHeight = left ? left->height : 0;
+            int rightHeight = right ? right->height : 0;
+            int height = std::max(leftHeight, rightHeight) + 1;
+            bool balanced = (left == nullptr || left->balanced) &&
+                            (right == nullptr || right->balanced) &&
+                            std::abs(leftHeight - rightHeight) <= 1;
+            if (height == node->height && balanced == node->balanced) return;
+            node->height = height;
+            node->balanced = balanced;
+            node = node->parent;
+        }
+    }
+
+    TrackedNode* root_;
+    size_t size_;
+};
+
+#endif // HEIGHT_TRACKED_TREE_H
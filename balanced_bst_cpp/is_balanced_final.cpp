@@ -1,132 +1,109 @@
 #include <iostream>
-#include <climits> // For INT_MAX and INT_MIN
 #include <exception> // For std::exception
+#include <stdexcept> // For std::runtime_error, std::overflow_error
+#include <vector>
+#include <random>
+#include <string>
+#include "balanced_tree.h"
+#include "node_arena.h"
+#include "flat_tree.h"
+#include "parallel_balance.h"
+#include "height_tracked_tree.h"
+#include "avl_tree.h"
+#include "balanced_build.h"
+#include "batch_balance.h"
+#include "tree_file.h"
+#include "stream_balance.h"
+#include "generic_balance.h"
+#include "tree_stats.h"
+#include "prefetch_balance.h"
 using namespace std;
 
-// Define the structure for a binary tree node
-struct Node {
-    int data;
-    Node* left;
-    Node* right;
-};
-
-// Function to create a new binary tree node with input validation
-Node* createNode(int data) {
-    Node* newNode = new Node();
-    if (newNode == nullptr) {
-        cout << "Memory allocation failed\n";
-        return nullptr;
-    }
-    newNode->data = data;
-    newNode->left = newNode->right = nullptr;
-    return newNode;
-}
+// Allocator used by the test cases below; nullptr means plain new/delete
+static NodeArena* treeArena = nullptr;
 
-// Function to safely delete a binary tree to prevent memory leaks
-void deleteTree(Node* root) {
-    if (root == nullptr) return;
-    deleteTree(root->left);
-    deleteTree(root->right);
-    delete root;
+Node* newNode(int data) {
+    return treeArena ? createNode(*treeArena, data) : createNode(data);
 }
 
-// Function to check if a binary tree is balanced and calculate its height
-int checkBalanceAndHeight(Node* root, bool& isBalanced, int maxDepth, int currentDepth) {
-    if (root == nullptr) return 0;
-
-    if (currentDepth > maxDepth) {
-        isBalanced = false;
-        throw overflow_error("Maximum depth exceeded, possible stack overflow.");
-    }
-
-    // Left subtree height
-    int leftHeight = checkBalanceAndHeight(root->left, isBalanced, maxDepth, currentDepth + 1);
-    if (!isBalanced) return 0;
-
-    // Right subtree height
-    int rightHeight = checkBalanceAndHeight(root->right, isBalanced, maxDepth, currentDepth + 1);
-    if (!isBalanced) return 0;
-
-    // Check balance condition
-    if (abs(leftHeight - rightHeight) > 1) isBalanced = false;
-
-    // Avoid integer overflow when calculating height
-    if (leftHeight > INT_MAX - 1 || rightHeight > INT_MAX - 1) {
-        isBalanced = false;
-        throw overflow_error("Height calculation overflow detected.");
-    }
-
-    return max(leftHeight, rightHeight) + 1;
+// With an arena, every tree of a test case is released at once: the cases
+// free all their trees together, so rewinding the whole arena is safe
+void freeTree(Node* root) {
+    if (treeArena) treeArena->reset(); else deleteTree(root);
 }
 
-// Wrapper function to check if a binary tree is balanced
-bool isTreeBalanced(Node* root, int maxDepth) {
-    bool isBalanced = true;
-    try {
-        checkBalanceAndHeight(root, isBalanced, maxDepth, 0);
-    } catch (const overflow_error& e) {
-        cout << "Overflow error: " << e.what() << endl;
-        isBalanced = false;
-    }
-    return isBalanced;
+// Diagnostics from the library are routed here instead of being printed by it
+void printBalanceError(BalanceError error, const char* message, void* context) {
+    (void)error;
+    (void)context;
+    cout << "Error: " << message << "\n";
 }
 
 // Example usage:
-int main() {
+//   ./is_balanced_final          nodes come from new/delete
+//   ./is_balanced_final --arena  nodes come from a NodeArena
+int main(int argc, char** argv) {
+    setBalanceLogger(printBalanceError);
+    NodeArena arena;
+    if (argc > 1 && string(argv[1]) == "--arena") {
+        treeArena = &arena;
+        cout << "Allocating nodes from a NodeArena\n";
+    }
+
     // Test Case 1: Basic Working Case
     cout << "\nTest 1: Basic working case\n";
     {
-        Node* root = createNode(1);
+        Node* root = newNode(1);
         if (root == nullptr) {
             cout << "Failed to create the root node." << endl;
             return 1;
         }
-        root->left = createNode(2);
-        root->right = createNode(3);
+        root->left = newNode(2);
+        root->right = newNode(3);
         cout << "Expected: true (balanced tree)\n";
-        if (isTreeBalanced(root, 1000)) {
+        if (isTreeBalanced(root)) {
             cout << "Actual: true\n";
         } else {
             cout << "Actual: false\n";
         }
-        deleteTree(root);
+        freeTree(root);
     }
 
-    // Test Case 2: Stack Overflow Handling
+    // Test Case 2: Deep tree is answered instead of rejected
     cout << "\nTest 2: Stack overflow with deep tree\n";
     {
-        Node* root = createNode(1);
+        Node* root = newNode(1);
         Node* current = root;
         try {
-            const int maxDepth = 1000; // Safeguard to prevent excessive depth
-            for (int i = 0; i < 2000; i++) { // Exceeding maxDepth will trigger an exception
-                current->left = createNode(i);
+            for (int i = 0; i < 2000; i++) {
+                current->left = newNode(i);
                 if (current->left == nullptr) throw runtime_error("Memory allocation failed.");
                 current = current->left;
             }
             cout << "Testing deep tree...\n";
-            bool result = isTreeBalanced(root, maxDepth);
+            cout << "Expected: false (left chain)\n";
+            bool result = isTreeBalanced(root);
             cout << "Result: " << (result ? "true" : "false") << endl;
         } catch (const exception& e) {
             cout << "Caught exception: " << e.what() << endl;
         }
-        deleteTree(root);
+        freeTree(root);
     }
 
     // Test Case 3: Integer Overflow
     cout << "\nTest 3: Integer overflow\n";
     {
-        Node* root = createNode(1);
+        Node* root = newNode(1);
         if (root == nullptr) {
             cout << "Failed to create the root node." << endl;
             return 1;
         }
         Node* current = root;
         for (int i = 0; i < 100; i++) {
-            Node* node = createNode(i);
+            Node* node = newNode(i);
             if (node == nullptr) {
                 cout << "Failed to create a node." << endl;
-                deleteTree(root);
+                freeTree(root);
                 return 1;
             }
             node->right = current;
@@ -134,7 +111,7 @@ int main() {
         }
         cout << "Testing tree with potential integer overflow...\n";
         try {
-            if (isTreeBalanced(root, 1000)) {
+            if (isTreeBalanced(root)) {
                 cout << "Result: true\n";
             } else {
                 cout << "Result: false\n";
@@ -142,22 +119,344 @@ int main() {
         } catch (const overflow_error& e) {
             cout << "Caught overflow error: " << e.what() << endl;
         }
-        deleteTree(current);
+        freeTree(current);
+    }
+
+    // Test Case 4: Degenerate tree tens of millions of levels deep
+    cout << "\nTest 4: Very deep degenerate tree\n";
+    {
+        const int depth = 20000000;
+        Node* root = newNode(0);
+        Node* current = root;
+        for (int i = 1; i < depth; i++) {
+            // Alternate sides to build a zig-zag chain, as sorted inserts would
+            Node* node = newNode(i);
+            if (i % 2) current->right = node; else current->left = node;
+            current = node;
+        }
+        cout << "Testing tree " << depth << " levels deep...\n";
+        cout << "Expected: false (zig-zag chain)\n";
+        cout << "Result: " << (isTreeBalanced(root) ? "true" : "false") << endl;
+        freeTree(root);
+    }
+
+    // Test Case 5: Iterative engine agrees with the recursive reference
+    cout << "\nTest 5: Agreement with recursive checker\n";
+    {
+        // Perfect tree of height 12 with one extra level hung off the far left
+        vector<Node*> level(1, newNode(0));
+        Node* root = level[0];
+        for (int h = 1; h < 12; h++) {
+            vector<Node*> next;
+            for (size_t i = 0; i < level.size(); i++) {
+                level[i]->left = newNode(h);
+                level[i]->right = newNode(h);
+                next.push_back(level[i]->left);
+                next.push_back(level[i]->right);
+            }
+            level.swap(next);
+        }
+        level[0]->left = newNode(12);
+        BalanceResult recursive = checkBalanceAndHeight(root, 1000);
+        int iterativeHeight = checkBalanceIterative(root);
+        cout << "Expected: true, height 13\n";
+        cout << "Recursive: " << (recursive.balanced ? "true" : "false") << ", height " << recursive.height << "\n";
+        cout << "Iterative: " << (iterativeHeight >= 0 ? "true" : "false") << ", height " << iterativeHeight << "\n";
+
+        // The same tree in flat layout, then unbalanced by one more level
+        FlatTree flat;
+        flattenTree(root, flat);
+        int flatHeight = checkBalanceFlat(flat);
+        cout << "Flat:      " << (flatHeight >= 0 ? "true" : "false") << ", height " << flatHeight << "\n";
+        int prefetchHeight = checkBalancePrefetch(root);
+        cout << "Prefetch:  " << (prefetchHeight >= 0 ? "true" : "false") << ", height " << prefetchHeight << "\n";
+        int interleavedHeight = checkBalanceInterleaved(root, 4, 3);
+        cout << "Interleaved: " << (interleavedHeight >= 0 ? "true" : "false") << ", height " << interleavedHeight << "\n";
+        // A negative split depth is clamped to 0: one lane walks the whole tree
+        int unsplitHeight = checkBalanceInterleaved(root, 4, -1);
+        cout << "Unsplit:   " << (unsplitHeight >= 0 ? "true" : "false") << ", height " << unsplitHeight << "\n";
+        level[0]->left->left = newNode(13);
+        flattenTree(root, flat);
+        cout << "Expected: false after growing the far-left branch\n";
+        cout << "Flat:      " << (isTreeBalanced(flat) ? "true" : "false") << "\n";
+        cout << "Interleaved: " << (checkBalanceInterleaved(root, 4, 3) >= 0 ? "true" : "false") << "\n";
+        freeTree(root);
+    }
+
+    // Test Case 6: Parallel check with forked subtrees and early exit
+    cout << "\nTest 6: Parallel balance check\n";
+    {
+        vector<Node*> level(1, newNode(0));
+        Node* root = level[0];
+        for (int h = 1; h < 14; h++) {
+            vector<Node*> next;
+            for (size_t i = 0; i < level.size(); i++) {
+                level[i]->left = newNode(h);
+                level[i]->right = newNode(h);
+                next.push_back(level[i]->left);
+                next.push_back(level[i]->right);
+            }
+            level.swap(next);
+        }
+        ParallelBalanceOptions options;
+        options.threads = 4;
+        options.forkDepth = 6;
+        cout << "Expected: true, height 14\n";
+        cout << "Parallel: height " << checkBalanceParallel(root, options) << "\n";
+
+        // Hang a chain off the last leaf so one stolen task fails
+        Node* current = level.back();
+        for (int i = 0; i < 3; i++) {
+            current->right = newNode(i);
+            current = current->right;
+        }
+        cout << "Expected: false after growing a chain under the rightmost leaf\n";
+        cout << "Parallel: " << (isTreeBalanced(root, options) ? "true" : "false") << "\n";
+        freeTree(root);
+    }
+
+    // Test Case 7: Cached heights stay in sync with a full recheck
+    cout << "\nTest 7: Incremental balance tracking (randomized)\n";
+    {
+        mt19937 rng(2024);
+        int mismatches = 0, balancedStates = 0, operations = 0;
+        // Many short-lived small trees so both answers come up often
+        for (int round = 0; round < 500; round++) {
+            HeightTrackedTree tree;
+            for (int op = 0; op < 40; op++, operations++) {
+                int key = static_cast<int>(rng() % 32);
+                if (rng() % 3 == 0) tree.erase(key); else tree.insert(key);
+
+                BalanceResult expected = checkBalanceAndHeight(tree.root(), 1000);
+                if (tree.isBalanced() != expected.balanced ||
+                    (expected.balanced && tree.height() != expected.height)) {
+                    mismatches++;
+                }
+                if (expected.balanced) balancedStates++;
+            }
+        }
+        cout << "Operations: " << operations << ", balanced states seen: " << balancedStates << "\n";
+        cout << "Expected: 0 mismatches\n";
+        cout << "Mismatches: " << mismatches << "\n";
+    }
+
+    // Test Case 8: Self-balancing container never degrades into a chain
+    cout << "\nTest 8: AVL tree with sorted inserts\n";
+    {
+        // The same 2000 sorted keys that build the chain in Test 2
+        AvlTree tree;
+        for (int i = 0; i < 2000; i++) tree.insert(i);
+        cout << "Expected: true, height 11\n";
+        cout << "Result: " << (isTreeBalanced(tree.root()) ? "true" : "false")
+             << ", height " << tree.height() << "\n";
+
+        // Erase every odd key, then walk what is left in order
+        for (int i = 1; i < 2000; i += 2) tree.erase(i);
+        int expectedKey = 0;
+        bool inOrder = true;
+        for (AvlTree::const_iterator it = tree.begin(); it != tree.end(); ++it, expectedKey += 2) {
+            if (*it != expectedKey) inOrder = false;
+        }
+        cout << "Expected: 1000 keys in order, lower_bound(501) = 502, find(501) fails\n";
+        cout << "Result: " << tree.size() << " keys " << (inOrder ? "in order" : "OUT OF ORDER")
+             << ", lower_bound(501) = " << *tree.lower_bound(501)
+             << ", find(501) " << (tree.find(501) == tree.end() ? "fails" : "succeeds") << "\n";
+    }
+
+    // Test Case 9: Bulk load from sorted keys and in-place rebalancing
+    cout << "\nTest 9: Bulk load and rebalance\n";
+    {
+        vector<int> keys(1000);
+        for (int i = 0; i < 1000; i++) keys[i] = i * 3;
+        Node* root = buildBalanced(keys.data(), keys.size());
+        cout << "Expected: true, height 10, leftmost key 0\n";
+        const Node* leftmost = root;
+        while (leftmost->left != nullptr) leftmost = leftmost->left;
+        cout << "Result: " << (isTreeBalanced(root) ? "true" : "false") << ", height "
+             << checkBalanceIterative(root) << ", leftmost key " << leftmost->data << "\n";
+        deleteBalancedTree(root);
+
+        // The 2000-deep left chain from Test 2, straightened out in place
+        Node* chain = newNode(2000);
+        Node* current = chain;
+        for (int i = 1999; i > 0; i--) {
+            current->left = newNode(i);
+            current = current->left;
+        }
+        chain = rebalance(chain);
+        cout << "Expected: true, height 11 after rebalancing a 2000-node chain\n";
+        cout << "Result: " << (isTreeBalanced(chain) ? "true" : "false") << ", height "
+             << checkBalanceIterative(chain) << "\n";
+        freeTree(chain);
+    }
+
+    // Test Case 10: Batch validation with a result bitmap and error codes
+    cout << "\nTest 10: Batch validation\n";
+    {
+        // Every third tree is a 3-node chain, the rest are 3-node perfect trees
+        const size_t count = 3000;
+        vector<Node*> roots(count);
+        for (size_t i = 0; i < count; i++) {
+            roots[i] = newNode(1);
+            if (i % 3 == 0) {
+                roots[i]->left = newNode(2);
+                roots[i]->left->left = newNode(3);
+            } else {
+                roots[i]->left = newNode(2);
+                roots[i]->right = newNode(3);
+            }
+        }
+        vector<uint64_t> bits((count + 63) / 64);
+        vector<BalanceError> errors(count);
+        BatchBalanceValidator validator(4);
+        size_t balanced = validator.validate(roots.data(), count, bits.data(), errors.data());
+        size_t wrong = 0;
+        for (size_t i = 0; i < count; i++) {
+            bool bit = (bits[i / 64] >> (i % 64)) & 1;
+            BalanceError expected = i % 3 == 0 ? BalanceError::Unbalanced : BalanceError::None;
+            if (bit != (i % 3 != 0) || errors[i] != expected) wrong++;
+        }
+        cout << "Expected: 2000 balanced, 0 wrong results\n";
+        cout << "Result: " << balanced << " balanced, " << wrong << " wrong results\n";
+        for (size_t i = 0; i < count; i++) freeTree(roots[i]);
+    }
+
+    // Test Case 11: Status results instead of exceptions
+    cout << "\nTest 11: Depth limit reported as an error code\n";
+    {
+        Node* root = newNode(0);
+        Node* current = root;
+        for (int i = 1; i < 2000; i++) {
+            current->left = newNode(i);
+            current = current->left;
+        }
+        int logged = 0;
+        setBalanceLogger([](BalanceError, const char*, void* context) { ++*static_cast<int*>(context); },
+                         &logged);
+        BalanceResult limited = checkBalanceAndHeight(root, 1000);
+        BalanceResult unlimited = checkBalanceAndHeight(root, 5000);
+        setBalanceLogger(printBalanceError);
+        cout << "Expected: DepthLimitExceeded (logged once), then Unbalanced (not logged)\n";
+        cout << "Result: " << balanceErrorMessage(limited.error) << " / "
+             << balanceErrorMessage(unlimited.error) << ", logged " << logged << "\n";
+        freeTree(root);
+    }
+
+    // Test Case 12: Serialized tree checked straight from a memory mapping
+    cout << "\nTest 12: Memory-mapped tree file\n";
+    {
+        vector<int> keys(5000);
+        for (int i = 0; i < 5000; i++) keys[i] = i;
+        Node* root = buildBalanced(keys.data(), keys.size());
+        const char* path = "/tmp/is_balanced_final.tree";
+        MappedTree mapped;
+        bool written = writeTreeFile(root, path) && mapped.open(path);
+        cout << "Expected: 5000 nodes, height 13, root value 2500\n";
+        if (written) {
+            cout << "Result: " << mapped.size() << " nodes, height " << checkBalanceMapped(mapped)
+                 << ", root value " << mapped.data()[0] << "\n";
+        } else {
+            cout << "Result: could not write or map " << path << "\n";
+        }
+
+        // Skew the tree and write it again
+        Node* current = root;
+        while (current->right != nullptr) current = current->right;
+        Node* extra[2] = { createNode(5000), createNode(5001) };
+        current->right = extra[0];
+        extra[0]->right = extra[1];
+        written = writeTreeFile(root, path) && mapped.open(path);
+        cout << "Expected: false after hanging a chain under the rightmost node\n";
+        cout << "Result: " << (written && isTreeBalanced(mapped) ? "true" : "false") << "\n";
+        current->right = nullptr;
+        deleteTree(extra[0]);
+        deleteBalancedTree(root);
+        mapped.close();
+        remove(path);
+    }
+
+    // Test Case 13: Validating a token stream without building the tree
+    cout << "\nTest 13: Streaming validation of a pre-order token stream\n";
+    {
+        // Tree of Test 1 followed by a skewed tree, each fed in 3-byte chunks
+        const string streams[] = { "1 2 # # 3 # #", "1 2 4 # # # #", "1 2 # #" };
+        const char* expected[] = { "2", "unbalanced", "malformed" };
+        for (int s = 0; s < 3; s++) {
+            StreamingBalanceValidator validator;
+            for (size_t i = 0; i < streams[s].size(); i += 3) {
+                validator.feed(streams[s].data() + i, min<size_t>(3, streams[s].size() - i));
+            }
+            int height = validator.finish();
+            cout << "Expected: " << expected[s] << "\n";
+            cout << "Result: "
+                 << (height == HEIGHT_UNBALANCED ? "unbalanced"
+                     : height == HEIGHT_MALFORMED ? "malformed" : to_string(height)) << "\n";
+        }
+    }
+
+    cout << "\nTest 14: Generic checker over Node and FlatTree layouts\n";
+    {
+        // Heights 3 (left) and 1 (right): unbalanced for tolerance 1, not for 2
+        Node* root = newNode(1);
+        root->left = newNode(2);
+        root->left->left = newNode(3);
+        root->left->left->left = newNode(4);
+        root->right = newNode(5);
+        FlatTree flat;
+        flattenTree(root, flat);
+        FlatTreeTraits flatTraits(flat);
+        uint32_t flatRoot = flat.empty() ? FLAT_TREE_NIL : 0;
+        cout << "Expected: -1 -1 4 4\n";
+        cout << "Result: " << checkBalanceGeneric<PointerNodeTraits<Node>>(root) << " "
+             << checkBalanceGeneric<FlatTreeTraits>(flatRoot, flatTraits) << " "
+             << checkBalanceGeneric<PointerNodeTraits<Node>, 2>(root) << " "
+             << checkBalanceGeneric<FlatTreeTraits, 2>(flatRoot, flatTraits) << "\n";
+        freeTree(root);
+    }
+
+    cout << "\nTest 15: Tree statistics in one pass\n";
+    {
+        // Same shape as Test 14: the worst imbalance (2) is first seen at node 2
+        Node* root = newNode(1);
+        root->left = newNode(2);
+        root->left->left = newNode(3);
+        root->left->left->left = newNode(4);
+        root->right = newNode(5);
+        TreeStats stats;
+        analyzeTree(root, stats);
+        cout << "Expected: height 4, nodes 5, min leaf depth 1, worst imbalance 2 at node 2, levels 1 2 1 1\n";
+        cout << "Result: height " << stats.height << ", nodes " << stats.nodes
+             << ", min leaf depth " << stats.minLeafDepth << ", worst imbalance " << stats.worstImbalance
+             << " at node " << (stats.worstNode ? stats.worstNode->data : -1) << ", levels";
+        for (size_t d = 0; d < stats.levelCounts.size(); d++) cout << " " << stats.levelCounts[d];
+        cout << "\n";
+
+        freeTree(root);
+
+        // The fast mode stops after the balance check when it passes
+        root = newNode(1);
+        root->left = newNode(2);
+        root->right = newNode(3);
+        analyzeTree(root, stats, TreeStatsMode::BalancedOnly);
+        cout << "Expected: height 2, full pass skipped\n";
+        cout << "Result: height " << stats.height << ", full pass "
+             << (stats.complete ? "run" : "skipped") << "\n";
+        freeTree(root);
     }
 
-    // Test Case 4: Invalid Pointer Handling
-    cout << "\nTest 4: Invalid pointer handling\n";
+    // Final Test Case: Invalid Pointer Handling (runs last, dereferencing it is undefined behaviour)
+    cout << "\nFinal test: Invalid pointer handling\n";
     {
-        Node* root = createNode(1);
+        Node* root = newNode(1);
         if (root == nullptr) {
             cout << "Failed to create the root node." << endl;
             return 1;
         }
-        root->left = createNode(2);
+        root->left = newNode(2);
         root->right = reinterpret_cast<Node*>(0xDEADBEEF); // Invalid pointer
         cout << "Testing with invalid pointer...\n";
         try {
-            if (isTreeBalanced(root, 1000)) {
+            if (isTreeBalanced(root)) {
                 cout << "Result: true\n";
             } else {
                 cout << "Result: false\n";
@@ -166,7 +465,7 @@ int main() {
             cout << "Caught an exception!\n";
         }
         root->right = nullptr; // Prevent deleteTree from dereferencing invalid pointer
-        deleteTree(root);
+        freeTree(root);
     }
 
     return 0;
@@ -0,0 +1,102 @@
+#ifndef NODE_ARENA_H
+#define NODE_ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+#include "balanced_tree.h"
+
+// Hands out Nodes from large contiguous slabs instead of one `new` per node.
+// Individual nodes are never freed; the whole arena is rewound at once, so
+// tearing down a tree costs one free per slab rather than one per node.
+// An arena is meant to back a single tree (or a group of trees that die
+// together) and is not thread-safe.
+class NodeArena {
+public:
+    explicit NodeArena(size_t firstSlabNodes = 1024, size_t maxSlabNodes = 1 << 20)
+        : nextSlabNodes_(firstSlabNodes ? firstSlabNodes : 1),
+          maxSlabNodes_(maxSlabNodes < nextSlabNodes_ ? nextSlabNodes_ : maxSlabNodes),
+          cursor_(nullptr), end_(nullptr), allocated_(0) {}
+
+    ~NodeArena() { release(); }
+
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+
+    // Returns uninitialised storage for one Node, or nullptr if a new slab
+    // could not be obtained.
+    Node* allocate() {
+        if (cursor_ == end_ && !grow()) return nullptr;
+        ++allocated_;
+        return cursor_++;
+    }
+
+    // Rewinds the arena, invalidating every node it handed out. The first
+    // slab is kept for reuse; the rest are returned to the system.
+    void reset() {
+        if (slabs_.empty()) return;
+        for (size_t i = 1; i < slabs_.size(); i++) delete[] slabs_[i].nodes;
+        slabs_.resize(1);
+        cursor_ = slabs_[0].nodes;
+        end_ = cursor_ + slabs_[0].count;
+        allocated_ = 0;
+    }
+
+    // Returns every slab to the system.
+    void release() {
+        for (size_t i = 0; i < slabs_.size(); i++) delete[] slabs_[i].nodes;
+        slabs_.clear();
+        cursor_ = end_ = nullptr;
+        allocated_ = 0;
+    }
+
+    size_t nodesAllocated() const { return allocated_; }
+
+    size_t bytesReserved() const {
+        size_t total = 0;
+        for (size_t i = 0; i < slabs_.size(); i++) total += slabs_[i].count * sizeof(Node);
+        return total;
+    }
+
+private:
+    struct Slab {
+        Node* nodes;
+        size_t count;
+    };
+
+    // Slabs double in size up to maxSlabNodes_ so small trees stay small and
+    // large trees need only a handful of system allocations.
+    bool grow() {
+        Node* nodes = new (std::nothrow) Node[nextSlabNodes_];
+        if (nodes == nullptr) return false;
+        Slab slab = { nodes, nextSlabNodes_ };
+        slabs_.push_back(slab);
+        cursor_ = nodes;
+        end_ = nodes + nextSlabNodes_;
+        if (nextSlabNodes_ < maxSlabNodes_) {
+            nextSlabNodes_ = nextSlabNodes_ * 2 < maxSlabNodes_ ? nextSlabNodes_ * 2 : maxSlabNodes_;
+        }
+        return true;
+    }
+
+    std::vector<Slab> slabs_;
+    size_t nextSlabNodes_;
+    size_t maxSlabNodes_;
+    Node* cursor_;
+    Node* end_;
+    size_t allocated_;
+};
+
+// Function to create a new binary tree node inside an arena
+inline Node* createNode(NodeArena& arena, int data) {
+    Node* newNode = arena.allocate();
+    if (newNode == nullptr) {
+        logBalanceError(BalanceError::OutOfMemory);
+        return nullptr;
+    }
+    newNode->data = data;
+    newNode->left = newNode->right = nullptr;
+    return newNode;
+}
+
+#endif // NODE_ARENA_H
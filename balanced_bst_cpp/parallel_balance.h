@@ -0,0 +1,176 @@
+#ifndef PARALLEL_BALANCE_H
+#define PARALLEL_BALANCE_H
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "balanced_tree.h"
+
+// Settings for the parallel balance check
+struct ParallelBalanceOptions {
+    // Worker threads including the caller; 0 means hardware_concurrency()
+    unsigned threads;
+    // Subtrees rooted deeper than this are checked sequentially instead of
+    // being split into further tasks
+    int forkDepth;
+
+    ParallelBalanceOptions() : threads(0), forkDepth(12) {}
+};
+
+namespace parallel_balance_detail {
+
+// A subtree whose height is wanted. Lives on the stack of the worker that
+// forked it, which does not return before the task is done.
+struct Task {
+    const Node* node;
+    int depth;
+    int height;
+    std::atomic<bool> done;
+
+    Task(const Node* n, int d) : node(n), depth(d), height(0), done(false) {}
+};
+
+// Per-worker deque: the owner pushes and pops at the back, thieves take the
+// oldest (and therefore largest) task from the front.
+struct TaskQueue {
+    std::mutex lock;
+    std::deque<Task*> tasks;
+};
+
+class Run {
+public:
+    Run(unsigned threads, int forkDepth)
+        : forkDepth_(forkDepth), unbalanced_(false), outOfMemory_(false), finished_(false) {
+        for (unsigned i = 0; i < threads; i++) {
+            queues_.push_back(std::unique_ptr<TaskQueue>(new TaskQueue()));
+            scratch_.push_back(BalanceStack());
+        }
+    }
+
+    int check(const Node* root) {
+        std::vector<std::thread> workers;
+        for (unsigned i = 1; i < queues_.size(); i++) {
+            workers.push_back(std::thread(&Run::workerLoop, this, i));
+        }
+        int height = solve(root, 0, 0);
+        finished_.store(true, std::memory_order_release);
+        for (size_t i = 0; i < workers.size(); i++) workers[i].join();
+        if (outOfMemory_.load()) return HEIGHT_OUT_OF_MEMORY;
+        return unbalanced_.load() ? HEIGHT_UNBALANCED : height;
+    }
+
+private:
+    int solve(const Node* node, int depth, unsigned self) {
+        if (node == nullptr) return 0;
+        if (unbalanced_.load(std::memory_order_relaxed)) return HEIGHT_UNBALANCED;
+        if (depth >= forkDepth_) {
+            int height = checkBalanceIterative(node, scratch_[self], &unbalanced_);
+            if (height == HEIGHT_OUT_OF_MEMORY) outOfMemory_.store(true, std::memory_order_relaxed);
+            if (height < 0) unbalanced_.store(true, std::memory_order_relaxed);
+            return height;
+        }
+
+        // Offer the right subtree to thieves while this worker takes the left
+        Task right(node->right, depth + 1);
+        bool forked = node->right != nullptr;
+        if (forked) push(self, &right);
+        int leftHeight = solve(node->left, depth + 1, self);
+
+        int rightHeight = 0;
+        if (forked) {
+            if (popIfBack(self, &right)) {
+                rightHeight = solve(node->right, depth + 1, self);
+            } else {
+                // Stolen: keep executing other tasks until the thief is done
+                while (!right.done.load(std::memory_order_acquire)) {
+                    if (!runOne(self)) std::this_thread::yield();
+                }
+                rightHeight = right.height;
+            }
+        }
+
+        if (leftHeight < 0 || rightHeight < 0) return HEIGHT_UNBALANCED;
+        if (std::abs(leftHeight - rightHeight) > 1) {
+            unbalanced_.store(true, std::memory_order_relaxed);
+            return HEIGHT_UNBALANCED;
+        }
+        return std::max(leftHeight, rightHeight) + 1;
+    }
+
+    void push(unsigned self, Task* task) {
+        std::lock_guard<std::mutex> guard(queues_[self]->lock);
+        queues_[self]->tasks.push_back(task);
+    }
+
+    bool popIfBack(unsigned self, Task* task) {
+        std::lock_guard<std::mutex> guard(queues_[self]->lock);
+        std::deque<Task*>& tasks = queues_[self]->tasks;
+        if (tasks.empty() || tasks.back() != task) return false;
+        tasks.pop_back();
+        return true;
+    }
+
+    // Takes the newest task from our own queue, otherwise steals the oldest
+    // task from another worker, and runs it. Returns false if none was found.
+    bool runOne(unsigned self) {
+        Task* task = nullptr;
+        {
+            std::lock_guard<std::mutex> guard(queues_[self]->lock);
+            std::deque<Task*>& tasks = queues_[self]->tasks;
+            if (!tasks.empty()) {
+                task = tasks.back();
+                tasks.pop_back();
+            }
+        }
+        for (size_t i = 1; task == nullptr && i < queues_.size(); i++) {
+            TaskQueue& victim = *queues_[(self + i) % queues_.size()];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+            }
+        }
+        if (task == nullptr) return false;
+        task->height = solve(task->node, task->depth, self);
+        task->done.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void workerLoop(unsigned self) {
+        while (!finished_.load(std::memory_order_acquire)) {
+            if (!runOne(self)) std::this_thread::yield();
+        }
+    }
+
+    int forkDepth_;
+    // Raised by the first failing subtree; doubles as the cancel signal
+    std::atomic<bool> unbalanced_;
+    std::atomic<bool> outOfMemory_;
+    std::atomic<bool> finished_;
+    std::vector<std::unique_ptr<TaskQueue> > queues_;
+    std::vector<BalanceStack> scratch_;
+};
+
+} // namespace parallel_balance_detail
+
+// Parallel balance check. Subtrees down to options.forkDepth are split into
+// tasks that idle workers steal; deeper subtrees are walked by the iterative
+// engine. The first unbalanced subtree raises a shared flag and every worker
+// abandons its remaining work. Returns the tree height, HEIGHT_UNBALANCED or
+// HEIGHT_OUT_OF_MEMORY, like checkBalanceIterative.
+inline int checkBalanceParallel(const Node* root, const ParallelBalanceOptions& options) {
+    unsigned threads = options.threads;
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    parallel_balance_detail::Run run(threads, options.forkDepth);
+    return run.check(root);
+}
+
+inline bool isTreeBalanced(const Node* root, const ParallelBalanceOptions& options) {
+    return checkBalanceParallel(root, options) >= 0;
+}
+
+#endif // PARALLEL_BALANCE_H
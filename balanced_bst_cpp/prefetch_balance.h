@@ -0,0 +1,147 @@
+#ifndef PREFETCH_BALANCE_H
+#define PREFETCH_BALANCE_H
+
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+#include "balanced_tree.h"
+#include "generic_balance.h"
+
+// Balance checks that hide pointer-chasing latency on trees too large for
+// the cache. Both return the same values as checkBalanceIterative.
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BALANCE_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define BALANCE_PREFETCH(address) ((void)(address))
+#endif
+
+namespace prefetch_balance_detail {
+
+// Prefetches the right child of each node pushed by the walk
+struct PrefetchRightVisitor : BalanceVisitor {
+    void enter(const Node* node, size_t, bool leaf) {
+        if (!leaf) BALANCE_PREFETCH(node->right);
+    }
+};
+
+// Also pauses before every move to a child, once its load is in flight
+struct InterleaveVisitor : PrefetchRightVisitor {
+    bool pauseAt(const Node* node) {
+        BALANCE_PREFETCH(node);
+        return true;
+    }
+};
+
+} // namespace prefetch_balance_detail
+
+// checkBalanceIterative with a prefetch of each deferred right child, issued
+// when its parent is pushed. Near the leaves, where most nodes are, the
+// right child is needed only a few nodes later, so its miss overlaps with
+// the walk down the left subtree.
+inline int checkBalancePrefetch(const Node* root, BalanceStack& stack) {
+    return checkBalanceGeneric<PointerNodeTraits<Node>, 1, prefetch_balance_detail::PrefetchRightVisitor>(root, stack);
+}
+
+inline int checkBalancePrefetch(const Node* root) {
+    BalanceStack stack;
+    return checkBalancePrefetch(root, stack);
+}
+
+namespace prefetch_balance_detail {
+
+// One resumable post-order walk. step() advances until the walk needs a node
+// that is not yet known to be cached, prefetches it and returns, so that
+// other lanes can run while the load is in flight.
+class Lane {
+public:
+    void start(const Node* root) {
+        walk_.start(root);
+        if (root != nullptr) BALANCE_PREFETCH(root);
+    }
+
+    bool done() const { return walk_.done(); }
+
+    // Once done: the height, HEIGHT_UNBALANCED or HEIGHT_OUT_OF_MEMORY
+    int height() const { return walk_.height(); }
+
+    void step() { walk_.run(stack_); }
+
+private:
+    BalanceStack stack_;
+    GenericBalanceWalk<PointerNodeTraits<Node>, 1, InterleaveVisitor> walk_;
+};
+
+// Subtrees rooted at splitDepth, left to right
+inline void collectSubtrees(const Node* node, int depth, int splitDepth, std::vector<const Node*>& out) {
+    if (node == nullptr) return;
+    if (depth == splitDepth) {
+        out.push_back(node);
+        return;
+    }
+    collectSubtrees(node->left, depth + 1, splitDepth, out);
+    collectSubtrees(node->right, depth + 1, splitDepth, out);
+}
+
+// Checks the levels above splitDepth, taking the subtree heights in the order
+// collectSubtrees produced them
+inline int combineTop(const Node* node, int depth, int splitDepth, const std::vector<int>& heights, size_t& next) {
+    if (node == nullptr) return 0;
+    if (depth == splitDepth) return heights[next++];
+    int leftHeight = combineTop(node->left, depth + 1, splitDepth, heights, next);
+    if (leftHeight < 0) return leftHeight;
+    int rightHeight = combineTop(node->right, depth + 1, splitDepth, heights, next);
+    if (rightHeight < 0) return rightHeight;
+    if (std::abs(leftHeight - rightHeight) > 1) return HEIGHT_UNBALANCED;
+    return std::max(leftHeight, rightHeight) + 1;
+}
+
+} // namespace prefetch_balance_detail
+
+// Interleaved check: the tree is cut at splitDepth into up to 2^splitDepth
+// independent subtrees, which `lanes` resumable walks check in round-robin
+// order, one node per turn. Each lane prefetches its next node and then
+// yields, so up to `lanes` cache misses are in flight at once. The levels
+// above the cut are combined afterwards, recursing splitDepth levels deep;
+// splitDepth is clamped to [0, MAX_SPLIT_DEPTH].
+const int MAX_SPLIT_DEPTH = 30;
+
+inline int checkBalanceInterleaved(const Node* root, unsigned lanes = 8, int splitDepth = 8) {
+    using namespace prefetch_balance_detail;
+    if (lanes == 0) lanes = 1;
+    splitDepth = std::max(0, std::min(splitDepth, MAX_SPLIT_DEPTH));
+    std::vector<const Node*> subtrees;
+    collectSubtrees(root, 0, splitDepth, subtrees);
+    std::vector<int> heights(subtrees.size());
+
+    std::vector<Lane> walks(std::min<size_t>(lanes, subtrees.size()));
+    std::vector<size_t> owner(walks.size());
+    size_t nextSubtree = 0;
+    size_t active = 0;
+    for (size_t i = 0; i < walks.size(); i++) {
+        owner[i] = nextSubtree;
+        walks[i].start(subtrees[nextSubtree++]);
+        active++;
+    }
+    while (active > 0) {
+        for (size_t i = 0; i < walks.size(); i++) {
+            Lane& lane = walks[i];
+            if (lane.done()) continue;
+            lane.step();
+            if (!lane.done()) continue;
+            if (lane.height() < 0) return lane.height();
+            heights[owner[i]] = lane.height();
+            if (nextSubtree < subtrees.size()) {
+                owner[i] = nextSubtree;
+                lane.start(subtrees[nextSubtree++]);
+            } else {
+                active--;
+            }
+        }
+    }
+
+    size_t next = 0;
+    return combineTop(root, 0, splitDepth, heights, next);
+}
+
+#endif // PREFETCH_BALANCE_H
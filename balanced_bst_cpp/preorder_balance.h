@@ -0,0 +1,128 @@
+#ifndef PREORDER_BALANCE_H
+#define PREORDER_BALANCE_H
+
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+#include "balanced_tree.h"
+
+// Return value for a serialized tree whose structure does not describe
+// exactly one complete tree
+const int HEIGHT_MALFORMED = -3;
+
+// Balance check over a tree described one node at a time in pre-order.
+// Nodes arrive either with their child flags (node()) or, for serialisations
+// that spell out missing children, as beginNode() followed by the two child
+// subtrees, each possibly a nullChild(). Nothing is built: the checker keeps
+// one small frame per unfinished inner node on the current path, so memory
+// is O(height) however the nodes arrive.
+class PreorderBalanceChecker {
+public:
+    PreorderBalanceChecker() : state_(Running), height_(0) {}
+
+    void reset() {
+        frames_.clear();
+        state_ = Running;
+        height_ = 0;
+    }
+
+    // Feeds the next node. Returns false once the answer is known to be
+    // "unbalanced" or the input is malformed; further nodes are then
+    // ignored.
+    bool node(bool hasLeft, bool hasRight) {
+        if (state_ != Running) {
+            // A node after the tree was complete is malformed input
+            if (state_ == Complete) state_ = Malformed;
+            return false;
+        }
+        if (!hasLeft && !hasRight) return deliver(1);
+        Frame frame = { 0, hasLeft, hasRight };
+        frames_.push_back(frame);
+        return true;
+    }
+
+    // Starts a node whose two children follow, in pre-order, as subtrees or
+    // nullChild() markers
+    bool beginNode() {
+        if (state_ != Running) {
+            if (state_ == Complete) state_ = Malformed;
+            return false;
+        }
+        Frame frame = { 0, true, true };
+        frames_.push_back(frame);
+        return true;
+    }
+
+    // A missing child (or, as the first token, an empty tree)
+    bool nullChild() {
+        if (state_ != Running) {
+            if (state_ == Complete) state_ = Malformed;
+            return false;
+        }
+        return deliver(0);
+    }
+
+    // True once the root's subtree has been completely described
+    bool complete() const { return state_ == Complete; }
+
+    // True once the input is known to be unbalanced or malformed
+    bool failed() const { return state_ == Unbalanced || state_ == Malformed; }
+
+    // Tree height, HEIGHT_UNBALANCED, or HEIGHT_MALFORMED if the input ended
+    // early or carried extra nodes. An empty input is an empty tree.
+    int result() const {
+        switch (state_) {
+        case Complete: return height_;
+        case Unbalanced: return HEIGHT_UNBALANCED;
+        case Malformed: return HEIGHT_MALFORMED;
+        case Running: return frames_.empty() ? 0 : HEIGHT_MALFORMED;
+        }
+        return HEIGHT_MALFORMED;
+    }
+
+    size_t depth() const { return frames_.size(); }
+
+private:
+    // An inner node still waiting for one or both child heights
+    struct Frame {
+        int leftHeight;
+        bool needLeft;
+        bool needRight;
+    };
+
+    enum State { Running, Complete, Unbalanced, Malformed };
+
+    // Hands a finished subtree's height to its parent, completing as many
+    // ancestors as that finishes.
+    bool deliver(int height) {
+        while (!frames_.empty()) {
+            Frame& top = frames_.back();
+            int leftHeight, rightHeight;
+            if (top.needLeft) {
+                top.needLeft = false;
+                top.leftHeight = height;
+                if (top.needRight) return true;
+                leftHeight = height;
+                rightHeight = 0;
+            } else {
+                leftHeight = top.leftHeight;
+                rightHeight = height;
+            }
+            if (std::abs(leftHeight - rightHeight) > 1) {
+                state_ = Unbalanced;
+                return false;
+            }
+            height = std::max(leftHeight, rightHeight) + 1;
+            frames_.pop_back();
+        }
+        height_ = height;
+        state_ = Complete;
+        return true;
+    }
+
+    std::vector<Frame> frames_;
+    State state_;
+    int height_;
+};
+
+#endif // PREORDER_BALANCE_H
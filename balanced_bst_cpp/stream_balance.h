@@ -0,0 +1,148 @@
+#ifndef STREAM_BALANCE_H
+#define STREAM_BALANCE_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <unistd.h>
+#include "balanced_tree.h"
+#include "preorder_balance.h"
+
+// Validates a tree serialised as a pre-order token stream with null markers,
+// e.g. "1 2 # # 3 # #", without ever building it. Tokens are integers
+// (optional leading '-') or '#', separated by any ASCII whitespace. Input
+// may be split into chunks at arbitrary byte positions, including inside a
+// token; only O(height) state is kept between chunks.
+class StreamingBalanceValidator {
+public:
+    StreamingBalanceValidator() { reset(); }
+
+    void reset() {
+        checker_.reset();
+        token_ = None;
+        malformed_ = false;
+        nodes_ = 0;
+        bytes_ = 0;
+    }
+
+    // Consumes the next chunk. Returns false once the outcome is decided
+    // (unbalanced or malformed), after which the rest of the input may be
+    // skipped.
+    bool feed(const char* data, size_t length) {
+        bytes_ += length;
+        if (malformed_ || checker_.failed()) return false;
+        // Work on a local copy of the token state: stores through `data`
+        // (a char pointer) could otherwise alias it and force a reload per
+        // byte.
+        Token token = token_;
+        const char* p = data;
+        const char* end = data + length;
+        while (p < end) {
+            if (token == None) {
+                while (p < end && isSpace(*p)) p++;
+                if (p == end) break;
+                char c = *p++;
+                if (isDigit(c)) token = Number;
+                else if (c == '#') token = Null;
+                else if (c == '-') token = Minus;
+                else return fail();
+            }
+            // Finish the current token, which may continue into the next chunk
+            if (token != Null) {
+                const char* digits = p;
+                p = skipDigits(p, end);
+                if (p != digits) token = Number;
+            }
+            if (p == end) break;
+            if (!isSpace(*p++)) return fail();
+            token_ = None;
+            if (!endToken(token)) return false;
+            token = None;
+        }
+        token_ = token;
+        return true;
+    }
+
+    // Ends the input. Returns the tree height, HEIGHT_UNBALANCED or
+    // HEIGHT_MALFORMED.
+    int finish() {
+        if (!malformed_ && token_ != None) endToken(token_);
+        token_ = None;
+        if (malformed_) return HEIGHT_MALFORMED;
+        return checker_.result();
+    }
+
+    uint64_t nodes() const { return nodes_; }
+    uint64_t bytes() const { return bytes_; }
+
+private:
+    enum Token { None, Minus, Number, Null };
+
+    static bool isDigit(char c) { return static_cast<unsigned char>(c - '0') < 10; }
+
+    // Returns the first non-digit in [p, end), testing eight bytes at a time.
+    // A byte is a digit iff its high nibble is 3 and adding 6 to it keeps the
+    // high nibble at 3. Carries from the addition only move towards later
+    // bytes, so the first non-digit byte is always detected correctly.
+    static const char* skipDigits(const char* p, const char* end) {
+        const uint64_t highNibbles = 0xF0F0F0F0F0F0F0F0ull;
+        const uint64_t threes = 0x3030303030303030ull;
+        const uint64_t sixes = 0x0606060606060606ull;
+        while (end - p >= 8) {
+            uint64_t word;
+            std::memcpy(&word, p, sizeof(word));
+            uint64_t nonDigits = ((word & highNibbles) ^ threes) | (((word + sixes) & highNibbles) ^ threes);
+            if (nonDigits != 0) return p + (__builtin_ctzll(nonDigits) >> 3);
+            p += 8;
+        }
+        while (p < end && isDigit(*p)) p++;
+        return p;
+    }
+
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\n' || (c >= '\t' && c <= '\r');
+    }
+
+    bool endToken(Token token) {
+        if (token == Minus) return fail();
+        if (token == Null) return checker_.nullChild();
+        ++nodes_;
+        return checker_.beginNode();
+    }
+
+    bool fail() {
+        malformed_ = true;
+        return false;
+    }
+
+    PreorderBalanceChecker checker_;
+    Token token_;
+    bool malformed_;
+    uint64_t nodes_;
+    uint64_t bytes_;
+};
+
+// Return value of validateBalanceStream when read() fails
+const int HEIGHT_READ_ERROR = -4;
+
+// Streams fd to the end (or until the outcome is decided) through a fixed
+// buffer. Returns the tree height, HEIGHT_UNBALANCED, HEIGHT_MALFORMED, or
+// HEIGHT_READ_ERROR.
+inline int validateBalanceStream(int fd, StreamingBalanceValidator& validator,
+                                 size_t bufferSize = 1 << 20) {
+    std::vector<char> buffer(bufferSize);
+    validator.reset();
+    for (;;) {
+        ssize_t got = ::read(fd, buffer.data(), buffer.size());
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            return HEIGHT_READ_ERROR;
+        }
+        if (got == 0) break;
+        if (!validator.feed(buffer.data(), static_cast<size_t>(got))) break;
+    }
+    return validator.finish();
+}
+
+#endif // STREAM_BALANCE_H
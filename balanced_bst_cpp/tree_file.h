@@ -0,0 +1,191 @@
+#ifndef TREE_FILE_H
+#define TREE_FILE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "balanced_tree.h"
+#include "preorder_balance.h"
+
+// On-disk tree format, native (little-endian) byte order:
+//
+//   TreeFileHeader                      32 bytes
+//   structure  uint64_t[(2n + 63) / 64] two bits per node in pre-order:
+//                                       bit 0 = has left, bit 1 = has right
+//   data       int32_t[n]               node values in the same order
+//
+// The structure section is enough to check balance, so a mapped file can be
+// validated without touching the data or building any Nodes.
+struct TreeFileHeader {
+    char magic[8];
+    uint64_t nodeCount;
+    uint64_t structureOffset;
+    uint64_t dataOffset;
+};
+
+const char TREE_FILE_MAGIC[8] = { 'B', 'A', 'L', 'T', 'R', 'E', 'E', '1' };
+
+inline uint64_t treeFileStructureWords(uint64_t nodeCount) {
+    return (2 * nodeCount + 63) / 64;
+}
+
+namespace tree_file_detail {
+
+// Calls visit(node) for every node in pre-order, without recursion
+template <typename Visit>
+void preorder(const Node* root, Visit visit) {
+    std::vector<const Node*> pending;
+    if (root != nullptr) pending.push_back(root);
+    while (!pending.empty()) {
+        const Node* node = pending.back();
+        pending.pop_back();
+        visit(node);
+        if (node->right != nullptr) pending.push_back(node->right);
+        if (node->left != nullptr) pending.push_back(node->left);
+    }
+}
+
+} // namespace tree_file_detail
+
+// Writes root to path in the format above. Returns false on any I/O error.
+inline bool writeTreeFile(const Node* root, const char* path) {
+    uint64_t nodeCount = 0;
+    tree_file_detail::preorder(root, [&](const Node*) { ++nodeCount; });
+
+    TreeFileHeader header;
+    std::memcpy(header.magic, TREE_FILE_MAGIC, sizeof(header.magic));
+    header.nodeCount = nodeCount;
+    header.structureOffset = sizeof(TreeFileHeader);
+    header.dataOffset = header.structureOffset + treeFileStructureWords(nodeCount) * sizeof(uint64_t);
+
+    FILE* file = std::fopen(path, "wb");
+    if (file == nullptr) return false;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+
+    // Structure bits, flushed a word at a time
+    uint64_t word = 0;
+    unsigned filled = 0;
+    tree_file_detail::preorder(root, [&](const Node* node) {
+        uint64_t flags = (node->left != nullptr ? 1u : 0u) | (node->right != nullptr ? 2u : 0u);
+        word |= flags << filled;
+        filled += 2;
+        if (filled == 64) {
+            ok = ok && std::fwrite(&word, sizeof(word), 1, file) == 1;
+            word = 0;
+            filled = 0;
+        }
+    });
+    if (filled != 0) ok = ok && std::fwrite(&word, sizeof(word), 1, file) == 1;
+
+    tree_file_detail::preorder(root, [&](const Node* node) {
+        int32_t value = node->data;
+        ok = ok && std::fwrite(&value, sizeof(value), 1, file) == 1;
+    });
+
+    return std::fclose(file) == 0 && ok;
+}
+
+// Read-only memory mapping of a tree file. Pages are loaded by the kernel
+// on first touch, so opening is O(1) regardless of the tree's size.
+class MappedTree {
+public:
+    MappedTree() : base_(nullptr), length_(0), nodeCount_(0), structure_(nullptr), data_(nullptr) {}
+    ~MappedTree() { close(); }
+
+    MappedTree(const MappedTree&) = delete;
+    MappedTree& operator=(const MappedTree&) = delete;
+
+    // Maps path and validates its header; returns false if the file cannot
+    // be mapped or is not a complete tree file.
+    bool open(const char* path) {
+        close();
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(TreeFileHeader))) {
+            ::close(fd);
+            return false;
+        }
+        length_ = static_cast<size_t>(info.st_size);
+        void* base = ::mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED) return false;
+        base_ = base;
+
+        const TreeFileHeader* header = static_cast<const TreeFileHeader*>(base_);
+        uint64_t count = header->nodeCount;
+        uint64_t words = treeFileStructureWords(count);
+        bool valid = std::memcmp(header->magic, TREE_FILE_MAGIC, sizeof(header->magic)) == 0 &&
+                     count <= length_ / sizeof(int32_t) &&
+                     header->structureOffset % sizeof(uint64_t) == 0 &&
+                     header->structureOffset <= length_ &&
+                     words <= (length_ - header->structureOffset) / sizeof(uint64_t) &&
+                     header->dataOffset % sizeof(int32_t) == 0 &&
+                     header->dataOffset <= length_ &&
+                     count <= (length_ - header->dataOffset) / sizeof(int32_t);
+        if (!valid) {
+            close();
+            return false;
+        }
+        const char* bytes = static_cast<const char*>(base_);
+        nodeCount_ = count;
+        structure_ = reinterpret_cast<const uint64_t*>(bytes + header->structureOffset);
+        data_ = reinterpret_cast<const int32_t*>(bytes + header->dataOffset);
+        return true;
+    }
+
+    void close() {
+        if (base_ != nullptr) ::munmap(base_, length_);
+        base_ = nullptr;
+        length_ = 0;
+        nodeCount_ = 0;
+        structure_ = nullptr;
+        data_ = nullptr;
+    }
+
+    bool isOpen() const { return base_ != nullptr; }
+    uint64_t size() const { return nodeCount_; }
+    const uint64_t* structure() const { return structure_; }
+    const int32_t* data() const { return data_; }
+
+    // Child flags of the i-th node in pre-order
+    unsigned childFlags(uint64_t i) const {
+        return static_cast<unsigned>(structure_[i / 32] >> (2 * (i % 32))) & 3u;
+    }
+
+private:
+    void* base_;
+    size_t length_;
+    uint64_t nodeCount_;
+    const uint64_t* structure_;
+    const int32_t* data_;
+};
+
+// Balance check straight off the mapped structure bitmap. Returns the tree
+// height, HEIGHT_UNBALANCED, or HEIGHT_MALFORMED if the bitmap does not
+// describe exactly size() nodes.
+inline int checkBalanceMapped(const MappedTree& tree) {
+    PreorderBalanceChecker checker;
+    const uint64_t* structure = tree.structure();
+    uint64_t remaining = tree.size();
+    for (uint64_t w = 0; remaining > 0; w++) {
+        uint64_t word = structure[w];
+        unsigned nodes = remaining < 32 ? static_cast<unsigned>(remaining) : 32u;
+        for (unsigned k = 0; k < nodes; k++, word >>= 2) {
+            if (!checker.node((word & 1) != 0, (word & 2) != 0)) return checker.result();
+        }
+        remaining -= nodes;
+    }
+    return checker.result();
+}
+
+inline bool isTreeBalanced(const MappedTree& tree) {
+    return checkBalanceMapped(tree) >= 0;
+}
+
+#endif // TREE_FILE_H
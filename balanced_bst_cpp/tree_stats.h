@@ -0,0 +1,98 @@
+#ifndef TREE_STATS_H
+#define TREE_STATS_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "balanced_tree.h"
+#include "generic_balance.h"
+
+// Shape summary of a tree, gathered in one pass by analyzeTree. Depths
+// count from 0 at the root; height counts levels, as elsewhere.
+struct TreeStats {
+    int height;
+    uint64_t nodes;
+    int minLeafDepth;                   // shallowest leaf, -1 for an empty tree
+    int worstImbalance;                 // largest |left height - right height|
+    const Node* worstNode;              // first node in post-order with that imbalance
+    std::vector<uint64_t> levelCounts;  // nodes at each depth
+    bool complete;                      // false if the fast mode skipped the full pass
+
+    bool balanced() const { return worstImbalance <= 1; }
+};
+
+enum class TreeStatsMode {
+    Full,          // always gather every statistic
+    BalancedOnly   // check balance first and gather the rest only if it fails
+};
+
+namespace tree_stats_detail {
+
+// Fills TreeStats from the hooks of a walk with tolerance 0, which reports
+// every node with any imbalance and is never stopped by one
+class StatsVisitor : public BalanceVisitor {
+public:
+    explicit StatsVisitor(TreeStats& stats) : stats_(&stats) {}
+
+    void enter(const Node*, size_t depth, bool leaf) {
+        TreeStats& stats = *stats_;
+        if (depth == stats.levelCounts.size()) stats.levelCounts.push_back(0);
+        stats.levelCounts[depth]++;
+        stats.nodes++;
+        if (leaf && (stats.minLeafDepth < 0 || static_cast<int>(depth) < stats.minLeafDepth)) {
+            stats.minLeafDepth = static_cast<int>(depth);
+        }
+    }
+
+    bool unbalanced(const Node* node, int imbalance) {
+        if (imbalance > stats_->worstImbalance) {
+            stats_->worstImbalance = imbalance;
+            stats_->worstNode = node;
+        }
+        return false;
+    }
+
+private:
+    TreeStats* stats_;
+};
+
+} // namespace tree_stats_detail
+
+// Walks the tree once, without recursion, and fills stats. In BalancedOnly
+// mode a balanced tree costs a single checkBalanceIterative pass and only
+// height is filled in (complete stays false). Returns None, Unbalanced or
+// OutOfMemory if the traversal stack could not grow.
+inline BalanceError analyzeTree(const Node* root, TreeStats& stats, BalanceStack& stack,
+                                TreeStatsMode mode = TreeStatsMode::Full) {
+    stats.height = 0;
+    stats.nodes = 0;
+    stats.minLeafDepth = -1;
+    stats.worstImbalance = 0;
+    stats.worstNode = nullptr;
+    stats.levelCounts.clear();
+    stats.complete = false;
+
+    if (mode == TreeStatsMode::BalancedOnly) {
+        int height = checkBalanceIterative(root, stack);
+        if (height == HEIGHT_OUT_OF_MEMORY) return BalanceError::OutOfMemory;
+        if (height >= 0) {
+            stats.height = height;
+            return BalanceError::None;
+        }
+    }
+
+    int height = checkBalanceGeneric<PointerNodeTraits<Node>, 0>(root, stack, PointerNodeTraits<Node>(),
+                                                                 tree_stats_detail::StatsVisitor(stats));
+    if (height == HEIGHT_OUT_OF_MEMORY) return BalanceError::OutOfMemory;
+    stats.height = height;
+    stats.complete = true;
+    return stats.balanced() ? BalanceError::None : BalanceError::Unbalanced;
+}
+
+inline BalanceError analyzeTree(const Node* root, TreeStats& stats,
+                                TreeStatsMode mode = TreeStatsMode::Full) {
+    BalanceStack stack;
+    return analyzeTree(root, stats, stack, mode);
+}
+
+#endif // TREE_STATS_H
@@ -0,0 +1,610 @@
+// Benchmarks for the coordinate parsing and validation in coordinate.h.
+//
+//   g++ -std=c++11 -O2 -pthread bench_coords.cpp -o bench_coords
+//   ./bench_coords                   run every section
+//   ./bench_coords parse [values]
+//   ./bench_coords batch [points]
+//   ./bench_coords errors [calls]
+//   ./bench_coords file [rows] [max_threads]
+//   ./bench_coords validator [values]
+//   ./bench_coords index [points] [queries]
+//   ./bench_coords packed [points]
+//   ./bench_coords input [lines]
+//   ./bench_coords distance [matrix_side] [max_threads]
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <random>
+#include <sstream>
+#include <new>
+#include <cstdlib>
+#include <thread>
+#include "coordinate.h"
+#include "coordinate_batch.h"
+#include "coordinate_file.h"
+#include "coordinate_validator.h"
+#include "coordinate_index.h"
+#include "coordinate_packed.h"
+#include "coordinate_input.h"
+#include "coordinate_distance.h"
+using namespace std;
+
+// Every heap allocation in this program goes through here so the "errors"
+// section can report allocations per call
+static long allocationCount = 0;
+
+void* operator new(size_t size) {
+    allocationCount++;
+    void* memory = malloc(size ? size : 1);
+    if (memory == nullptr) throw bad_alloc();
+    return memory;
+}
+
+void operator delete(void* memory) noexcept { free(memory); }
+void operator delete(void* memory, size_t) noexcept { free(memory); }
+
+// Runs fn `reps` times and returns the fastest wall-clock time in milliseconds
+template <typename Fn>
+double bestOf(int reps, Fn fn) {
+    double best = 0;
+    for (int r = 0; r < reps; r++) {
+        auto start = chrono::steady_clock::now();
+        fn();
+        auto stop = chrono::steady_clock::now();
+        double ms = chrono::duration<double, milli>(stop - start).count();
+        if (r == 0 || ms < best) best = ms;
+    }
+    return best;
+}
+
+void report(const char* input, const char* engine, long values, double ms, long accepted) {
+    cout << left << setw(22) << input << setw(14) << engine
+         << right << setw(10) << values << setw(12) << fixed << setprecision(1) << ms << " ms"
+         << setw(10) << setprecision(1) << (values / ms / 1000.0) << " Mvalues/s"
+         << "  accepted " << accepted << "\n";
+}
+
+// GPS-feed style values: latitude or longitude with 4 to 8 decimals, as a
+// receiver or a JSON encoder would print them
+vector<string> gpsValues(long n, uint32_t seed) {
+    mt19937 rng(seed);
+    uniform_real_distribution<double> degrees(-180.0, 180.0);
+    vector<string> values;
+    values.reserve(n);
+    char text[64];
+    for (long i = 0; i < n; i++) {
+        snprintf(text, sizeof(text), "%.*f", 4 + static_cast<int>(rng() % 5), degrees(rng));
+        values.push_back(text);
+    }
+    return values;
+}
+
+// Mix of awkward but valid forms and rejected inputs
+vector<string> mixedValues(long n, uint32_t seed) {
+    const char* forms[] = {
+        " 45.5", "-0.000001", "1.5e1", "+179.99999999", "12345678901234567890.5",
+        "abc", "123abc", "-90.0e999", "1e", " ", "4.9e-324", "-180\t"
+    };
+    const long count = sizeof(forms) / sizeof(forms[0]);
+    mt19937 rng(seed);
+    vector<string> values;
+    values.reserve(n);
+    for (long i = 0; i < n; i++) values.push_back(forms[rng() % count]);
+    return values;
+}
+
+template <typename Parse>
+long parseAll(const vector<string>& values, Parse parse) {
+    long accepted = 0;
+    double value;
+    for (size_t i = 0; i < values.size(); i++) {
+        if (parse(values[i], value).isValid) accepted++;
+    }
+    return accepted;
+}
+
+// parseCoordinate against the istringstream reference
+void benchParse(long n) {
+    const int reps = 3;
+    cout << "\n== parseCoordinate, " << n << " values ==\n";
+    cout << left << setw(22) << "input" << setw(14) << "parser"
+         << right << setw(10) << "values" << setw(15) << "best time" << setw(20) << "throughput" << "\n";
+
+    const char* names[] = { "gps", "mixed" };
+    vector<string> inputs[] = { gpsValues(n, 1), mixedValues(n, 2) };
+    for (int k = 0; k < 2; k++) {
+        long accepted = 0;
+        double ms = bestOf(reps, [&] { accepted = parseAll(inputs[k], parseCoordinateReference); });
+        report(names[k], "istringstream", n, ms, accepted);
+        ms = bestOf(reps, [&] {
+            accepted = parseAll(inputs[k], [](const string& text, double& value) { return parseCoordinate(text, value); });
+        });
+        report(names[k], "fast", n, ms, accepted);
+    }
+}
+
+// validateCoordinates at each SIMD level against a loop that calls
+// validateCoordinate twice per point; 1 in 1000 points is out of range
+void benchBatch(long n) {
+    const int reps = 5;
+    mt19937 rng(3);
+    uniform_real_distribution<double> lat(-90.0, 90.0), lon(-180.0, 180.0);
+    vector<double> latitudes(n), longitudes(n);
+    for (long i = 0; i < n; i++) {
+        latitudes[i] = lat(rng);
+        longitudes[i] = i % 1000 == 999 ? 200.0 : lon(rng);
+    }
+    vector<uint64_t> bits((n + 63) / 64);
+
+    cout << "\n== batch validation, " << n << " points, CPU supports "
+         << coordinateSimdName(detectCoordinateSimd()) << " ==\n";
+    cout << left << setw(22) << "input" << setw(14) << "engine"
+         << right << setw(10) << "points" << setw(15) << "best time" << setw(20) << "throughput" << "\n";
+
+    long invalid = 0;
+    double ms = bestOf(reps, [&] {
+        invalid = 0;
+        for (long i = 0; i < n; i++) {
+            if (!validateCoordinate(latitudes[i], MIN_LAT, MAX_LAT, "Latitude").isValid ||
+                !validateCoordinate(longitudes[i], MIN_LON, MAX_LON, "Longitude").isValid) invalid++;
+        }
+    });
+    report("lat/lon arrays", "per value", n, ms, n - invalid);
+
+    const CoordinateSimd levels[] = { CoordinateSimd::Scalar, CoordinateSimd::Avx2, CoordinateSimd::Avx512 };
+    for (CoordinateSimd simd : levels) {
+        if (static_cast<int>(simd) > static_cast<int>(detectCoordinateSimd())) continue;
+        ms = bestOf(reps, [&] { invalid = validateCoordinates(latitudes.data(), longitudes.data(), n, bits.data(), simd); });
+        report("lat/lon arrays", coordinateSimdName(simd), n, ms, n - invalid);
+    }
+
+    vector<CoordinateFailure> failures;
+    ms = bestOf(reps, [&] {
+        failures.clear();
+        describeInvalidCoordinates(latitudes.data(), longitudes.data(), n, bits.data(), failures);
+    });
+    cout << "describing " << failures.size() << " failures took " << fixed << setprecision(1) << ms << " ms\n";
+}
+
+// validateCoordinate as it was when results carried a std::string message.
+// Kept here only as the "before" side of the errors benchmark.
+struct LegacyValidationResult {
+    bool isValid;
+    string message;
+    LegacyValidationResult(bool valid, const string& msg = "") : isValid(valid), message(msg) {}
+};
+
+LegacyValidationResult legacyValidateCoordinate(double value, double min, double max, const string& type) {
+    if (!isfinite(value)) {
+        return LegacyValidationResult(false, type + " must be finite");
+    }
+    if (value < min - EPSILON || value > max + EPSILON) {
+        ostringstream oss;
+        oss << type << " must be between " << min << " and " << max;
+        return LegacyValidationResult(false, oss.str());
+    }
+    return LegacyValidationResult(true);
+}
+
+template <typename Fn>
+void reportCalls(const char* input, const char* engine, int calls, Fn fn) {
+    long invalid = 0;
+    long before = allocationCount;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < calls; i++) invalid += fn(i) ? 0 : 1;
+    double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+    long allocations = allocationCount - before;
+    cout << left << setw(22) << input << setw(14) << engine
+         << right << setw(10) << calls << setw(12) << fixed << setprecision(1) << ns / calls << " ns"
+         << setw(12) << setprecision(2) << double(allocations) / calls << " allocs"
+         << "  rejected " << invalid << "\n";
+}
+
+// Cost per validateCoordinate call, old string results against error codes,
+// on valid, out-of-range and non-finite input
+void benchErrors(int calls) {
+    cout << "\n== validation results, " << calls << " calls each ==\n";
+    cout << left << setw(22) << "input" << setw(14) << "result type"
+         << right << setw(10) << "calls" << setw(15) << "per call" << setw(19) << "allocations" << "\n";
+
+    const char* names[] = { "in range", "out of range", "infinity / NaN" };
+    const double inputs[][2] = { { 12.5, -45.25 }, { 95.0, -181.0 },
+                                 { numeric_limits<double>::infinity(), numeric_limits<double>::quiet_NaN() } };
+    for (int k = 0; k < 3; k++) {
+        const double* values = inputs[k];
+        reportCalls(names[k], "std::string", calls, [&](int i) {
+            return legacyValidateCoordinate(values[i & 1], MIN_LAT, MAX_LAT, "Latitude").isValid;
+        });
+        reportCalls(names[k], "error code", calls, [&](int i) {
+            return validateCoordinate(values[i & 1], MIN_LAT, MAX_LAT, "Latitude").isValid;
+        });
+    }
+}
+
+// Writes `rows` GPS-style rows, 1 in 1000 of them out of range
+void writeCoordinateFile(const char* path, long rows, bool ndjson) {
+    FILE* out = fopen(path, "w");
+    mt19937 rng(4);
+    uniform_real_distribution<double> lat(-90.0, 90.0), lon(-180.0, 180.0);
+    for (long i = 0; i < rows; i++) {
+        double la = lat(rng), lo = i % 1000 == 999 ? 200.0 : lon(rng);
+        if (ndjson) fprintf(out, "{\"lat\": %.6f, \"lon\": %.6f}\n", la, lo);
+        else fprintf(out, "%.6f,%.6f\n", la, lo);
+    }
+    fclose(out);
+}
+
+// validateCoordinateFile throughput on generated CSV and NDJSON dumps
+void benchFile(long rows, unsigned maxThreads) {
+    const char* path = "/tmp/bench_coords.data";
+    const char* rejectPath = "/tmp/bench_coords.rejects";
+    const char* names[] = { "csv", "ndjson" };
+    cout << "\n== file validation, " << rows << " rows ==\n";
+    cout << left << setw(10) << "format" << right << setw(8) << "threads" << setw(12) << "rows"
+         << setw(12) << "time" << setw(16) << "throughput" << setw(12) << "bandwidth" << "\n";
+    for (int k = 0; k < 2; k++) {
+        writeCoordinateFile(path, rows, k == 1);
+        for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+            CoordinateFileOptions options;
+            options.threads = threads;
+            CoordinateFileReport report;
+            double ms = bestOf(3, [&] { validateCoordinateFile(path, options, report, rejectPath); });
+            cout << left << setw(10) << names[k] << right << setw(8) << threads << setw(12) << report.rows
+                 << setw(9) << fixed << setprecision(1) << ms << " ms"
+                 << setw(10) << (report.rows / ms / 1000.0) << " Mrows/s"
+                 << setw(8) << setprecision(2) << (report.bytes / ms / 1e6) << " GB/s"
+                 << "  rejected " << report.rejected << "\n";
+        }
+    }
+    remove(path);
+    remove(rejectPath);
+}
+
+// validateCoordinate with bounds the compiler cannot see (read through
+// volatiles), with literal bounds, and Validator<Latitude>; 1 in 1000
+// values is out of range
+void benchValidator(long n) {
+    const int reps = 5;
+    mt19937 rng(5);
+    uniform_real_distribution<double> lat(-90.0, 90.0);
+    vector<double> values(n);
+    for (long i = 0; i < n; i++) values[i] = i % 1000 == 999 ? 95.0 : lat(rng);
+
+    cout << "\n== single-field validation, " << n << " values ==\n";
+    cout << left << setw(22) << "input" << setw(14) << "validator"
+         << right << setw(10) << "values" << setw(15) << "best time" << setw(20) << "throughput" << "\n";
+
+    volatile double runtimeMin = MIN_LAT, runtimeMax = MAX_LAT;
+    long accepted = 0;
+    double ms = bestOf(reps, [&] {
+        double min = runtimeMin, max = runtimeMax;
+        accepted = 0;
+        for (long i = 0; i < n; i++) accepted += validateCoordinate(values[i], min, max, "Latitude").isValid;
+    });
+    report("latitudes", "runtime", n, ms, accepted);
+
+    ms = bestOf(reps, [&] {
+        accepted = 0;
+        for (long i = 0; i < n; i++) accepted += validateCoordinate(values[i], MIN_LAT, MAX_LAT, "Latitude").isValid;
+    });
+    report("latitudes", "constant args", n, ms, accepted);
+
+    ms = bestOf(reps, [&] {
+        accepted = 0;
+        for (long i = 0; i < n; i++) accepted += Validator<Latitude>::validate(values[i]).isValid;
+    });
+    report("latitudes", "Validator<>", n, ms, accepted);
+}
+
+// CoordinateIndex build time, memory and query latency on uniformly
+// scattered points. Query centres are random; the "antimeridian" rows put
+// them within a degree of +-180 so every query is split in two.
+void benchIndex(long n, int queries) {
+    mt19937 rng(6);
+    uniform_real_distribution<double> lat(-90.0, 90.0), lon(-180.0, 180.0), edge(179.0, 181.0);
+    vector<double> latitudes(n), longitudes(n);
+    for (long i = 0; i < n; i++) {
+        latitudes[i] = lat(rng);
+        longitudes[i] = lon(rng);
+    }
+
+    cout << "\n== spatial index, " << n << " points ==\n";
+    auto start = chrono::steady_clock::now();
+    CoordinateIndex index(latitudes.data(), longitudes.data(), n);
+    double buildMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << "build " << fixed << setprecision(1) << buildMs << " ms, "
+         << setprecision(1) << double(index.memoryBytes()) / index.size() << " bytes/point\n";
+    cout << left << setw(26) << "query" << right << setw(10) << "queries" << setw(14) << "per query"
+         << setw(16) << "hits/query" << "\n";
+
+    const double radii[] = { 1.0, 10.0, 100.0 };
+    vector<uint32_t> found;
+    for (int wrap = 0; wrap < 2; wrap++) {
+        for (double radius : radii) {
+            vector<double> centres(2 * queries);
+            for (int q = 0; q < queries; q++) {
+                centres[2 * q] = uniform_real_distribution<double>(-60.0, 60.0)(rng);
+                centres[2 * q + 1] = wrap ? coordinate_index_detail::wrapLongitude(edge(rng)) : lon(rng);
+            }
+            for (int box = 0; box < 2; box++) {
+                long hits = 0;
+                auto begin = chrono::steady_clock::now();
+                for (int q = 0; q < queries; q++) {
+                    found.clear();
+                    double la = centres[2 * q], lo = centres[2 * q + 1];
+                    if (box) {
+                        // Box of about the same size as the circle
+                        double dLat = radius / 111.2, dLon = dLat / cos(la * 3.14159265358979 / 180.0);
+                        index.queryBox(CoordinateBox{ la - dLat, lo - dLon, la + dLat, lo + dLon }, found);
+                    } else {
+                        index.queryRadius(la, lo, radius, found);
+                    }
+                    hits += found.size();
+                }
+                double us = chrono::duration<double, micro>(chrono::steady_clock::now() - begin).count();
+                string name = string(box ? "box " : "radius ") + to_string(static_cast<int>(radius)) + " km" +
+                              (wrap ? " antimeridian" : "");
+                cout << left << setw(26) << name << right << setw(10) << queries
+                     << setw(11) << setprecision(2) << us / queries << " us"
+                     << setw(16) << setprecision(1) << double(hits) / queries << "\n";
+            }
+        }
+    }
+}
+
+// Fixed-point storage: bytes per point, encode/decode at each SIMD level,
+// and a box-count scan over doubles against the same scan over E7 integers
+void benchPacked(long n) {
+    const int reps = 5;
+    mt19937 rng(7);
+    uniform_real_distribution<double> lat(-90.0, 90.0), lon(-180.0, 180.0);
+    vector<double> latitudes(n), longitudes(n);
+    for (long i = 0; i < n; i++) {
+        latitudes[i] = lat(rng);
+        longitudes[i] = lon(rng);
+    }
+    vector<PackedCoordinate> packed(n);
+    vector<double> lat2(n), lon2(n);
+
+    cout << "\n== fixed-point storage, " << n << " points ==\n";
+    cout << left << setw(22) << "operation" << setw(14) << "engine"
+         << right << setw(10) << "points" << setw(15) << "best time" << setw(20) << "throughput" << "\n";
+    const CoordinateSimd levels[] = { CoordinateSimd::Scalar, CoordinateSimd::Avx2, CoordinateSimd::Avx512 };
+    for (CoordinateSimd simd : levels) {
+        if (static_cast<int>(simd) > static_cast<int>(detectCoordinateSimd())) continue;
+        double ms = bestOf(reps, [&] { encodeCoordinates(latitudes.data(), longitudes.data(), n, packed.data(), simd); });
+        report("encode", coordinateSimdName(simd), n, ms, n);
+        ms = bestOf(reps, [&] { decodeCoordinates(packed.data(), n, lat2.data(), lon2.data(), simd); });
+        report("decode", coordinateSimdName(simd), n, ms, n);
+    }
+
+    // Points inside a box covering about a quarter of the globe
+    const double south = -30, north = 30, west = -90, east = 90;
+    long inside = 0;
+    double ms = bestOf(reps, [&] {
+        inside = 0;
+        for (long i = 0; i < n; i++) {
+            inside += (latitudes[i] >= south) & (latitudes[i] <= north) & (longitudes[i] >= west) & (longitudes[i] <= east);
+        }
+    });
+    report("box scan", "double", n, ms, inside);
+    const int32_t s = encodeDegrees(south), no = encodeDegrees(north), w = encodeDegrees(west), e = encodeDegrees(east);
+    ms = bestOf(reps, [&] {
+        inside = 0;
+        for (long i = 0; i < n; i++) {
+            inside += (packed[i].lat >= s) & (packed[i].lat <= no) & (packed[i].lon >= w) & (packed[i].lon <= e);
+        }
+    });
+    report("box scan", "E7 int32", n, ms, inside);
+
+    // A walk with steps of a few metres, as a 1 Hz GPS track records
+    vector<PackedCoordinate> track(n);
+    normal_distribution<double> step(0.0, 3e-5);
+    double la = 47.0, lo = 8.0;
+    for (long i = 0; i < n; i++) {
+        la += step(rng);
+        lo += step(rng);
+        track[i].lat = encodeDegrees(la);
+        track[i].lon = encodeDegrees(lo);
+    }
+    vector<uint8_t> bytes;
+    ms = bestOf(reps, [&] {
+        bytes.clear();
+        encodeTrack(track.data(), n, bytes);
+    });
+    report("track encode", "delta varint", n, ms, n);
+    vector<PackedCoordinate> decoded;
+    decoded.reserve(n);
+    ms = bestOf(reps, [&] {
+        decoded.clear();
+        decodeTrack(bytes.data(), bytes.size(), decoded);
+    });
+    report("track decode", "delta varint", n, ms, static_cast<long>(decoded.size()));
+
+    cout << "bytes/point: double " << 2 * sizeof(double) << ", E7 " << sizeof(PackedCoordinate)
+         << ", track " << fixed << setprecision(2) << double(bytes.size()) / n << "\n";
+}
+
+// Returns the read end of a pipe that a background thread fills with text
+int feedPipe(const string& text, thread& writer) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("pipe");
+        exit(1);
+    }
+    writer = thread([&text, fds] {
+        for (size_t done = 0; done < text.size();) {
+            ssize_t count = write(fds[1], text.data() + done, text.size() - done);
+            if (count <= 0) break;
+            done += static_cast<size_t>(count);
+        }
+        close(fds[1]);
+    });
+    return fds[0];
+}
+
+// Lines per second through a pipe: getline on std::cin (with the pipe as
+// standard input, as getInput reads it) against CoordinateLineReader, each
+// splitting only and then also parsing every line
+void benchInput(long lines) {
+    const int reps = 3;
+    vector<string> values = gpsValues(lines, 8);
+    string text;
+    for (long i = 0; i < lines; i++) text += values[i] + "\n";
+
+    cout << "\n== piped input, " << lines << " lines, " << fixed << setprecision(1) << text.size() / 1e6 << " MB ==\n";
+    cout << left << setw(22) << "work" << setw(14) << "reader"
+         << right << setw(10) << "lines" << setw(15) << "best time" << setw(20) << "throughput" << "\n";
+
+    int savedStdin = dup(0);
+    for (int parse = 0; parse < 2; parse++) {
+        const char* work = parse ? "split + parse" : "split";
+        long accepted = 0;
+        double ms = bestOf(reps, [&] {
+            thread writer;
+            int fd = feedPipe(text, writer);
+            dup2(fd, 0);
+            close(fd);
+            clearerr(stdin);
+            cin.clear();
+            accepted = 0;
+            string line;
+            double value;
+            while (getline(cin, line)) accepted += parse ? parseCoordinate(line, value).isValid : 1;
+            writer.join();
+        });
+        report(work, "getline", lines, ms, accepted);
+
+        ms = bestOf(reps, [&] {
+            thread writer;
+            int fd = feedPipe(text, writer);
+            CoordinateLineReader reader(fd);
+            accepted = 0;
+            CoordinateLine line;
+            double value;
+            while (reader.next(line)) accepted += parse ? parseCoordinate(line.begin, line.end, value).isValid : 1;
+            writer.join();
+            close(fd);
+        });
+        report(work, "line reader", lines, ms, accepted);
+    }
+    dup2(savedStdin, 0);
+    close(savedStdin);
+    clearerr(stdin);
+    cin.clear();
+}
+
+// Floating-point operations per distance in the SIMD chord kernels, an FMA
+// counting as two. Scalar rows report the same nominal work, so their
+// GFLOP/s compare directly.
+const double FLOPS_PER_DISTANCE = 42;
+
+void reportDistances(const char* work, const char* engine, double distances, double ms) {
+    cout << left << setw(22) << work << setw(14) << engine
+         << right << setw(12) << static_cast<long>(distances) << setw(10) << fixed << setprecision(1) << ms << " ms"
+         << setw(10) << distances / ms / 1000.0 << " Mdist/s"
+         << setw(9) << setprecision(2) << distances * FLOPS_PER_DISTANCE / ms / 1e6 << " GFLOP/s\n";
+}
+
+// haversineKm per pair against the batch kernels at each SIMD level:
+// pairwise, one-to-many and a side x side matrix, then the matrix on
+// 1..maxThreads threads at the widest level
+void benchDistance(long side, unsigned maxThreads) {
+    const int reps = 3;
+    const long n = side * side;
+    mt19937 rng(9);
+    uniform_real_distribution<double> lat(-90.0, 90.0), lon(-180.0, 180.0);
+    vector<double> lat1(n), lon1(n), lat2(n), lon2(n), km(n);
+    for (long i = 0; i < n; i++) {
+        lat1[i] = lat(rng);
+        lon1[i] = lon(rng);
+        lat2[i] = lat(rng);
+        lon2[i] = lon(rng);
+    }
+
+    cout << "\n== batch distances, " << n << " pairs, " << side << " x " << side << " matrix ==\n";
+    cout << left << setw(22) << "work" << setw(14) << "engine"
+         << right << setw(12) << "distances" << setw(13) << "best time" << setw(18) << "throughput" << "\n";
+    double ms = bestOf(reps, [&] {
+        for (long i = 0; i < n; i++) km[i] = haversineKm(lat1[i], lon1[i], lat2[i], lon2[i]);
+    });
+    reportDistances("pairwise", "haversineKm", n, ms);
+    const CoordinateSimd levels[] = { CoordinateSimd::Scalar, CoordinateSimd::Avx2, CoordinateSimd::Avx512 };
+    for (CoordinateSimd simd : levels) {
+        if (static_cast<int>(simd) > static_cast<int>(detectCoordinateSimd())) continue;
+        ms = bestOf(reps, [&] { haversineDistances(lat1.data(), lon1.data(), lat2.data(), lon2.data(), n, km.data(), simd); });
+        reportDistances("pairwise", coordinateSimdName(simd), n, ms);
+    }
+
+    ms = bestOf(reps, [&] {
+        for (long i = 0; i < n; i++) km[i] = haversineKm(lat1[0], lon1[0], lat2[i], lon2[i]);
+    });
+    reportDistances("one-to-many", "haversineKm", n, ms);
+    for (CoordinateSimd simd : levels) {
+        if (static_cast<int>(simd) > static_cast<int>(detectCoordinateSimd())) continue;
+        ms = bestOf(reps, [&] { distancesFrom(lat1[0], lon1[0], lat2.data(), lon2.data(), n, km.data(), simd); });
+        reportDistances("one-to-many", coordinateSimdName(simd), n, ms);
+    }
+
+    ms = bestOf(reps, [&] {
+        for (long r = 0; r < side; r++) {
+            for (long c = 0; c < side; c++) km[r * side + c] = haversineKm(lat1[r], lon1[r], lat2[c], lon2[c]);
+        }
+    });
+    reportDistances("matrix", "haversineKm", n, ms);
+    for (CoordinateSimd simd : levels) {
+        if (static_cast<int>(simd) > static_cast<int>(detectCoordinateSimd())) continue;
+        ms = bestOf(reps, [&] {
+            distanceMatrix(lat1.data(), lon1.data(), side, lat2.data(), lon2.data(), side, km.data(), 1, simd);
+        });
+        reportDistances("matrix, 1 thread", coordinateSimdName(simd), n, ms);
+    }
+    for (unsigned threads = 2; threads <= maxThreads; threads *= 2) {
+        ms = bestOf(reps, [&] {
+            distanceMatrix(lat1.data(), lon1.data(), side, lat2.data(), lon2.data(), side, km.data(), threads);
+        });
+        string work = "matrix, " + to_string(threads) + " threads";
+        reportDistances(work.c_str(), coordinateSimdName(detectCoordinateSimd()), n, ms);
+    }
+}
+
+int main(int argc, char** argv) {
+    string section = argc > 1 ? argv[1] : "all";
+
+    if (section == "all" || section == "parse") {
+        benchParse(section == "parse" && argc > 2 ? atol(argv[2]) : 2000000);
+    }
+    if (section == "all" || section == "batch") {
+        benchBatch(section == "batch" && argc > 2 ? atol(argv[2]) : 10000000);
+    }
+    if (section == "all" || section == "errors") {
+        benchErrors(section == "errors" && argc > 2 ? atoi(argv[2]) : 1000000);
+    }
+    if (section == "all" || section == "file") {
+        unsigned cores = thread::hardware_concurrency();
+        benchFile(section == "file" && argc > 2 ? atol(argv[2]) : 10000000,
+                  section == "file" && argc > 3 ? atoi(argv[3]) : (cores ? cores : 1));
+    }
+    if (section == "all" || section == "validator") {
+        benchValidator(section == "validator" && argc > 2 ? atol(argv[2]) : 10000000);
+    }
+    if (section == "all" || section == "index") {
+        benchIndex(section == "index" && argc > 2 ? atol(argv[2]) : 10000000,
+                   section == "index" && argc > 3 ? atoi(argv[3]) : 10000);
+    }
+    if (section == "all" || section == "packed") {
+        benchPacked(section == "packed" && argc > 2 ? atol(argv[2]) : 10000000);
+    }
+    if (section == "all" || section == "input") {
+        benchInput(section == "input" && argc > 2 ? atol(argv[2]) : 5000000);
+    }
+    if (section == "all" || section == "distance") {
+        unsigned cores = thread::hardware_concurrency();
+        benchDistance(section == "distance" && argc > 2 ? atol(argv[2]) : 2000,
+                      section == "distance" && argc > 3 ? atoi(argv[3]) : (cores ? cores : 1));
+    }
+    return 0;
+}
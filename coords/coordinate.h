@@ -0,0 +1,318 @@
+#ifndef COORDINATE_H
+#define COORDINATE_H
+
+#include <iostream>
+#include <limits>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+constexpr double MIN_LAT = -90.0, MAX_LAT = 90.0;
+constexpr double MIN_LON = -180.0, MAX_LON = 180.0;
+constexpr double EPSILON = 1e-10;
+
+// Longest input parseCoordinate accepts
+const size_t MAX_COORDINATE_LENGTH = 50;
+
+// Why a parse or validation failed
+enum class CoordinateError : uint8_t {
+    None = 0,
+    InvalidLength,    // empty, or longer than MAX_COORDINATE_LENGTH
+    InvalidFormat,    // not a complete decimal number
+    NonFiniteInput,   // parsed to infinity or NaN
+    InputStream,      // reading the input failed
+    MaxAttempts,      // no valid input within the allowed attempts
+    NotFinite,        // field value is infinity or NaN
+    OutOfRange,       // field value outside [min, max]
+    MissingField      // a file row lacks the field
+};
+
+// Outcome of a parse or validation. It is trivially copyable and building
+// one never allocates: failures record a code plus the field, value and
+// bounds involved, and the text is only produced when message() or
+// formatMessage() is called. field must outlive the result (validation
+// passes string literals).
+struct ValidationResult {
+    bool isValid;
+    CoordinateError error;
+    const char* field;
+    double value;
+    double min;
+    double max;
+
+    static ValidationResult success() {
+        ValidationResult result = { true, CoordinateError::None, nullptr, 0.0, 0.0, 0.0 };
+        return result;
+    }
+
+    static ValidationResult failure(CoordinateError error, const char* field = nullptr,
+                                    double value = 0.0, double min = 0.0, double max = 0.0) {
+        ValidationResult result = { false, error, field, value, min, max };
+        return result;
+    }
+
+    // Writes the message into buffer like snprintf: the text is truncated
+    // to fit and NUL-terminated, and the full length is returned
+    size_t formatMessage(char* buffer, size_t size) const {
+        const char* name = field != nullptr ? field : "Value";
+        int length = 0;
+        switch (error) {
+        case CoordinateError::None:
+            if (size > 0) buffer[0] = '\0';
+            break;
+        case CoordinateError::InvalidLength: length = std::snprintf(buffer, size, "Invalid input length"); break;
+        case CoordinateError::InvalidFormat: length = std::snprintf(buffer, size, "Invalid number format"); break;
+        case CoordinateError::NonFiniteInput: length = std::snprintf(buffer, size, "Invalid value (infinity or NaN)"); break;
+        case CoordinateError::InputStream: length = std::snprintf(buffer, size, "Input stream error"); break;
+        case CoordinateError::MaxAttempts: length = std::snprintf(buffer, size, "Max attempts exceeded"); break;
+        case CoordinateError::NotFinite: length = std::snprintf(buffer, size, "%s must be finite", name); break;
+        case CoordinateError::MissingField: length = std::snprintf(buffer, size, "%s is missing", name); break;
+        // %g prints bounds the way the default ostream formatting did
+        case CoordinateError::OutOfRange:
+            length = std::snprintf(buffer, size, "%s must be between %g and %g", name, min, max);
+            break;
+        }
+        return length > 0 ? static_cast<size_t>(length) : 0;
+    }
+
+    std::string message() const {
+        char text[128];
+        size_t length = formatMessage(text, sizeof(text));
+        if (length < sizeof(text)) return std::string(text, length);
+        std::string longText(length + 1, '\0');
+        formatMessage(&longText[0], longText.size());
+        longText.resize(length);
+        return longText;
+    }
+};
+
+// The original istringstream-based parser. Kept as the reference that
+// parseCoordinate is tested and benchmarked against.
+inline ValidationResult parseCoordinateReference(const std::string& input, double& result) {
+    if (input.empty() || input.length() > MAX_COORDINATE_LENGTH) {
+        return ValidationResult::failure(CoordinateError::InvalidLength);
+    }
+
+    std::istringstream iss(input);
+    if (!(iss >> result) || (iss >> std::ws && !iss.eof())) {
+        return ValidationResult::failure(CoordinateError::InvalidFormat);
+    }
+
+    if (!std::isfinite(result)) {
+        return ValidationResult::failure(CoordinateError::NonFiniteInput);
+    }
+
+    return ValidationResult::success();
+}
+
+namespace coordinate_detail {
+
+// Whitespace as classified by the classic locale, which istringstream uses
+inline bool isSpace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+inline bool isDigit(char c) {
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+// How many of the eight input bytes in word (first byte in the low bits)
+// are digits before the first non-digit; 8 lets scanDigits take the whole
+// word. Digits are 0x30-0x39, so their high nibble is 3, and adding 6 pushes
+// 0x3A-0x3F out of it. A carry can spoil the test of a later byte but never
+// of an earlier one, and only the lowest flagged byte is used.
+inline unsigned leadingDigits(uint64_t word) {
+    const uint64_t highNibbles = 0xF0F0F0F0F0F0F0F0ull;
+    const uint64_t threes = 0x3030303030303030ull;
+    uint64_t nonDigits = ((word & highNibbles) ^ threes) |
+                         (((word + 0x0606060606060606ull) & highNibbles) ^ threes);
+    return nonDigits == 0 ? 8 : static_cast<unsigned>(__builtin_ctzll(nonDigits)) >> 3;
+}
+
+// Value of the first count (1..8) digits in word. Shifting the digits to
+// the top makes the vacated low bytes act as leading zeros.
+inline uint64_t digitsValue(uint64_t word, unsigned count) {
+    word = (word - 0x3030303030303030ull) << (8 * (8 - count));
+    word = word * 10 + (word >> 8);
+    word = ((word & 0x000000FF000000FFull) * 0x000F424000000064ull +
+            ((word >> 16) & 0x000000FF000000FFull) * 0x0000271000000001ull) >> 32;
+    return static_cast<uint32_t>(word);
+}
+
+// Appends the digit run at p to mantissa, eight digits at a time while at
+// least eight bytes remain. significant counts stored digits; leading
+// zeros may be counted too, which only makes truncation (and the exact
+// strtod fallback) kick in a little early. Returns the end of the run.
+inline const char* scanDigits(const char* p, const char* end, uint64_t& mantissa, int& significant,
+                              bool& truncated) {
+    static const uint64_t scale[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+    while (end - p >= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        unsigned count = leadingDigits(word);
+        if (count == 0) return p;
+        if (significant + static_cast<int>(count) > 19) break;
+        mantissa = mantissa * scale[count] + digitsValue(word, count);
+        significant += static_cast<int>(count);
+        p += count;
+        if (count < 8) return p;
+    }
+    for (; p < end && isDigit(*p); p++) {
+        if (mantissa == 0 && *p == '0') continue;
+        if (significant < 19) {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+            significant++;
+        } else {
+            truncated = true;
+        }
+    }
+    return p;
+}
+
+// Parses [begin, end) with the same rules as `iss >> value` followed by a
+// check that only whitespace remains: optional leading whitespace, an
+// optional sign, digits with at most one '.', and an optional exponent
+// with at least one digit. No hex, inf or nan. Overflow fails; underflow
+// rounds to zero or a subnormal like strtod.
+inline bool parseDecimal(const char* begin, const char* end, double& value) {
+    const char* p = begin;
+    while (p < end && isSpace(*p)) p++;
+    const char* number = p;
+
+    bool negative = false;
+    if (p < end && (*p == '+' || *p == '-')) {
+        negative = *p == '-';
+        p++;
+    }
+
+    // Up to 19 significant digits fit in a uint64_t
+    uint64_t mantissa = 0;
+    int significant = 0;
+    int exponent = 0;
+    bool truncated = false;
+    const char* digits = p;
+    p = scanDigits(p, end, mantissa, significant, truncated);
+    bool anyDigits = p != digits;
+    if (p < end && *p == '.') {
+        digits = ++p;
+        p = scanDigits(p, end, mantissa, significant, truncated);
+        anyDigits = anyDigits || p != digits;
+        // Exact unless truncated, and truncated values go through strtod
+        exponent -= static_cast<int>(p - digits);
+    }
+    if (!anyDigits) return false;
+
+    // Exponent; a trailing 'e' without digits fails, as it does in num_get
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool negativeExponent = false;
+        if (p < end && (*p == '+' || *p == '-')) {
+            negativeExponent = *p == '-';
+            p++;
+        }
+        if (p == end || !isDigit(*p)) return false;
+        int digits = 0;
+        for (; p < end && isDigit(*p); p++) {
+            if (digits < 100000) digits = digits * 10 + (*p - '0');
+        }
+        exponent += negativeExponent ? -digits : digits;
+    }
+    const char* numberEnd = p;
+
+    while (p < end && isSpace(*p)) p++;
+    if (p != end) return false;
+
+    // Exact when the mantissa and the power of ten are both representable,
+    // since a single multiplication or division then rounds correctly
+    static const double powersOfTen[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    if (mantissa == 0) {
+        value = negative ? -0.0 : 0.0;
+        return true;
+    }
+    if (!truncated && mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+        double magnitude = static_cast<double>(mantissa);
+        magnitude = exponent < 0 ? magnitude / powersOfTen[-exponent] : magnitude * powersOfTen[exponent];
+        value = negative ? -magnitude : magnitude;
+        return true;
+    }
+
+    // Rare cases go through strtod on a terminated copy. The grammar above
+    // is a subset of what strtod accepts in the "C" locale, so it consumes
+    // the whole copy.
+    char buffer[MAX_COORDINATE_LENGTH + 1];
+    size_t length = static_cast<size_t>(numberEnd - number);
+    if (length > MAX_COORDINATE_LENGTH) return false;
+    std::memcpy(buffer, number, length);
+    buffer[length] = '\0';
+    value = std::strtod(buffer, nullptr);
+    return std::isfinite(value);
+}
+
+} // namespace coordinate_detail
+
+// Parses one coordinate value without iostreams. Accepts exactly what
+// parseCoordinateReference accepts and produces the same value, assuming the
+// program runs in the default "C" locale. The text need not be terminated.
+inline ValidationResult parseCoordinate(const char* begin, const char* end, double& result) {
+    size_t length = static_cast<size_t>(end - begin);
+    if (length == 0 || length > MAX_COORDINATE_LENGTH) {
+        return ValidationResult::failure(CoordinateError::InvalidLength);
+    }
+
+    if (!coordinate_detail::parseDecimal(begin, end, result)) {
+        return ValidationResult::failure(CoordinateError::InvalidFormat);
+    }
+
+    if (!std::isfinite(result)) {
+        return ValidationResult::failure(CoordinateError::NonFiniteInput);
+    }
+
+    return ValidationResult::success();
+}
+
+inline ValidationResult parseCoordinate(const std::string& input, double& result) {
+    return parseCoordinate(input.data(), input.data() + input.size(), result);
+}
+
+inline ValidationResult getInput(const std::string& prompt, double& value) {
+    for (int attempts = 0; attempts < 3; ++attempts) {
+        std::cout << prompt;
+        std::string input;
+        std::getline(std::cin, input);
+
+        if (!std::cin.good()) {
+            std::cin.clear();
+            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            return ValidationResult::failure(CoordinateError::InputStream);
+        }
+
+        ValidationResult result = parseCoordinate(input, value);
+        if (result.isValid) return ValidationResult::success();
+        char message[128];
+        result.formatMessage(message, sizeof(message));
+        std::cout << "Error: " << message << "\n";
+    }
+    return ValidationResult::failure(CoordinateError::MaxAttempts);
+}
+
+// type names the field in the message ("Latitude") and must outlive the
+// result; a string literal does
+inline ValidationResult validateCoordinate(double value, double min, double max,
+                                  const char* type) {
+    if (!std::isfinite(value)) {
+        return ValidationResult::failure(CoordinateError::NotFinite, type, value);
+    }
+    if (value < min - EPSILON || value > max + EPSILON) {
+        return ValidationResult::failure(CoordinateError::OutOfRange, type, value, min, max);
+    }
+    return ValidationResult::success();
+}
+
+#endif // COORDINATE_H
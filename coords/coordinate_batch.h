@@ -0,0 +1,181 @@
+#ifndef COORDINATE_BATCH_H
+#define COORDINATE_BATCH_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "coordinate.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define COORDINATE_BATCH_X86 1
+#include <immintrin.h>
+#else
+#define COORDINATE_BATCH_X86 0
+#endif
+
+// Bracket AVX-512 kernels: GCC 12 warns about the deliberately undefined
+// pass-through operand inside the intrinsics
+#if defined(__GNUC__) && !defined(__clang__)
+#define COORDINATE_AVX512_DIAGNOSTICS_PUSH \
+    _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+#define COORDINATE_AVX512_DIAGNOSTICS_POP _Pragma("GCC diagnostic pop")
+#else
+#define COORDINATE_AVX512_DIAGNOSTICS_PUSH
+#define COORDINATE_AVX512_DIAGNOSTICS_POP
+#endif
+
+// Instruction set used by validateCoordinates
+enum class CoordinateSimd { Scalar, Avx2, Avx512 };
+
+inline const char* coordinateSimdName(CoordinateSimd simd) {
+    switch (simd) {
+    case CoordinateSimd::Scalar: return "scalar";
+    case CoordinateSimd::Avx2: return "avx2";
+    case CoordinateSimd::Avx512: return "avx512";
+    }
+    return "unknown";
+}
+
+// Widest instruction set this CPU supports, detected once
+inline CoordinateSimd detectCoordinateSimd() {
+#if COORDINATE_BATCH_X86
+    static const CoordinateSimd best = __builtin_cpu_supports("avx512f") ? CoordinateSimd::Avx512
+                                       : __builtin_cpu_supports("avx2") ? CoordinateSimd::Avx2
+                                       : CoordinateSimd::Scalar;
+    return best;
+#else
+    return CoordinateSimd::Scalar;
+#endif
+}
+
+namespace coordinate_batch_detail {
+
+// Accepted ranges, widened by EPSILON exactly as validateCoordinate does.
+// A value is valid iff lo <= value <= hi: NaN fails both comparisons and
+// the infinities fall outside the finite bounds, so no separate isfinite
+// test is needed.
+struct Bounds {
+    double latLo, latHi, lonLo, lonHi;
+
+    Bounds() : latLo(MIN_LAT - EPSILON), latHi(MAX_LAT + EPSILON),
+               lonLo(MIN_LON - EPSILON), lonHi(MAX_LON + EPSILON) {}
+};
+
+// Validity bits of up to 64 points
+inline uint64_t scalarWord(const double* lat, const double* lon, size_t n, const Bounds& b) {
+    uint64_t word = 0;
+    for (size_t i = 0; i < n; i++) {
+        bool ok = (lat[i] >= b.latLo) & (lat[i] <= b.latHi) & (lon[i] >= b.lonLo) & (lon[i] <= b.lonHi);
+        word |= static_cast<uint64_t>(ok) << i;
+    }
+    return word;
+}
+
+inline void validateScalar(const double* lat, const double* lon, size_t count, uint64_t* bits) {
+    Bounds b;
+    for (size_t base = 0; base < count; base += 64) {
+        bits[base / 64] = scalarWord(lat + base, lon + base, std::min<size_t>(64, count - base), b);
+    }
+}
+
+#if COORDINATE_BATCH_X86
+__attribute__((target("avx2")))
+inline void validateAvx2(const double* lat, const double* lon, size_t count, uint64_t* bits) {
+    Bounds b;
+    const __m256d latLo = _mm256_set1_pd(b.latLo), latHi = _mm256_set1_pd(b.latHi);
+    const __m256d lonLo = _mm256_set1_pd(b.lonLo), lonHi = _mm256_set1_pd(b.lonHi);
+    size_t base = 0;
+    for (; base + 64 <= count; base += 64) {
+        uint64_t word = 0;
+        for (size_t j = 0; j < 64; j += 4) {
+            __m256d la = _mm256_loadu_pd(lat + base + j);
+            __m256d lo = _mm256_loadu_pd(lon + base + j);
+            __m256d ok = _mm256_and_pd(
+                _mm256_and_pd(_mm256_cmp_pd(la, latLo, _CMP_GE_OQ), _mm256_cmp_pd(la, latHi, _CMP_LE_OQ)),
+                _mm256_and_pd(_mm256_cmp_pd(lo, lonLo, _CMP_GE_OQ), _mm256_cmp_pd(lo, lonHi, _CMP_LE_OQ)));
+            word |= static_cast<uint64_t>(_mm256_movemask_pd(ok)) << j;
+        }
+        bits[base / 64] = word;
+    }
+    if (base < count) bits[base / 64] = scalarWord(lat + base, lon + base, count - base, b);
+}
+
+__attribute__((target("avx512f")))
+inline void validateAvx512(const double* lat, const double* lon, size_t count, uint64_t* bits) {
+    Bounds b;
+    const __m512d latLo = _mm512_set1_pd(b.latLo), latHi = _mm512_set1_pd(b.latHi);
+    const __m512d lonLo = _mm512_set1_pd(b.lonLo), lonHi = _mm512_set1_pd(b.lonHi);
+    size_t base = 0;
+    for (; base + 64 <= count; base += 64) {
+        uint64_t word = 0;
+        for (size_t j = 0; j < 64; j += 8) {
+            __m512d la = _mm512_loadu_pd(lat + base + j);
+            __m512d lo = _mm512_loadu_pd(lon + base + j);
+            __mmask8 ok = _mm512_cmp_pd_mask(la, latLo, _CMP_GE_OQ);
+            ok = _mm512_mask_cmp_pd_mask(ok, la, latHi, _CMP_LE_OQ);
+            ok = _mm512_mask_cmp_pd_mask(ok, lo, lonLo, _CMP_GE_OQ);
+            ok = _mm512_mask_cmp_pd_mask(ok, lo, lonHi, _CMP_LE_OQ);
+            word |= static_cast<uint64_t>(ok) << j;
+        }
+        bits[base / 64] = word;
+    }
+    if (base < count) bits[base / 64] = scalarWord(lat + base, lon + base, count - base, b);
+}
+#endif
+
+} // namespace coordinate_batch_detail
+
+// Checks count points given as separate latitude and longitude arrays.
+// Bit i of validBits (which must hold (count + 63) / 64 words) is set iff
+// validateCoordinate would accept both latitudes[i] and longitudes[i];
+// unused bits of the last word are cleared. Returns the number of invalid
+// points. simd is lowered to what the CPU supports.
+inline size_t validateCoordinates(const double* latitudes, const double* longitudes, size_t count,
+                                  uint64_t* validBits, CoordinateSimd simd = detectCoordinateSimd()) {
+    using namespace coordinate_batch_detail;
+    CoordinateSimd best = detectCoordinateSimd();
+    if (static_cast<int>(simd) > static_cast<int>(best)) simd = best;
+#if COORDINATE_BATCH_X86
+    if (simd == CoordinateSimd::Avx512) validateAvx512(latitudes, longitudes, count, validBits);
+    else if (simd == CoordinateSimd::Avx2) validateAvx2(latitudes, longitudes, count, validBits);
+    else validateScalar(latitudes, longitudes, count, validBits);
+#else
+    validateScalar(latitudes, longitudes, count, validBits);
+#endif
+    size_t valid = 0;
+    for (size_t w = 0; w < (count + 63) / 64; w++) valid += static_cast<size_t>(__builtin_popcountll(validBits[w]));
+    return count - valid;
+}
+
+// Why one point failed. result is the first failing validateCoordinate
+// check, latitude before longitude.
+struct CoordinateFailure {
+    size_t index;
+    ValidationResult result;
+
+    CoordinateFailure(size_t i, const ValidationResult& r) : index(i), result(r) {}
+};
+
+// Produces messages for the points validateCoordinates rejected, in index
+// order, stopping after `limit` of them. Valid points cost nothing here.
+inline size_t describeInvalidCoordinates(const double* latitudes, const double* longitudes, size_t count,
+                                         const uint64_t* validBits, std::vector<CoordinateFailure>& out,
+                                         size_t limit = SIZE_MAX) {
+    size_t found = 0;
+    for (size_t w = 0; w < (count + 63) / 64 && found < limit; w++) {
+        uint64_t invalid = ~validBits[w];
+        if ((w + 1) * 64 > count) invalid &= (uint64_t(1) << (count - w * 64)) - 1;
+        while (invalid != 0 && found < limit) {
+            size_t i = w * 64 + static_cast<size_t>(__builtin_ctzll(invalid));
+            invalid &= invalid - 1;
+            ValidationResult result = validateCoordinate(latitudes[i], MIN_LAT, MAX_LAT, "Latitude");
+            if (result.isValid) result = validateCoordinate(longitudes[i], MIN_LON, MAX_LON, "Longitude");
+            out.push_back(CoordinateFailure(i, result));
+            found++;
+        }
+    }
+    return found;
+}
+
+#endif // COORDINATE_BATCH_H
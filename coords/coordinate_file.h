@@ -0,0 +1,297 @@
+#ifndef COORDINATE_FILE_H
+#define COORDINATE_FILE_H
+
+#include <atomic>
+#include <cerrno>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "coordinate.h"
+#include "coordinate_validator.h"
+
+// Offline validation of coordinate dumps: one point per line, either CSV
+// ("lat,lon") or NDJSON ({"lat": .., "lon": ..}). Every row goes through
+// parseCoordinate and the Validator equivalent of validateCoordinate, so
+// the rules are those of interactive input.
+
+enum class CoordinateFileFormat {
+    Auto,    // NDJSON if the first non-blank byte is '{', CSV otherwise
+    Csv,
+    Ndjson
+};
+
+struct CoordinateFileOptions {
+    CoordinateFileFormat format;
+    // Worker threads; 0 means hardware_concurrency()
+    unsigned threads;
+    // Target chunk size; chunks are extended to the next newline
+    size_t chunkBytes;
+
+    CoordinateFileOptions() : format(CoordinateFileFormat::Auto), threads(0), chunkBytes(4 << 20) {}
+};
+
+struct CoordinateFileReport {
+    uint64_t bytes;
+    uint64_t rows;       // non-blank lines, excluding a CSV header line
+    uint64_t valid;
+    uint64_t rejected;
+    int error;           // errno of the failure if validation returned false, else 0
+};
+
+namespace coordinate_file_detail {
+
+// A rejected row, numbered within its chunk until the chunks are merged
+struct Reject {
+    uint64_t line;
+    CoordinateError error;
+    bool longitude;
+};
+
+struct Chunk {
+    const char* begin;
+    const char* end;
+    uint64_t lines;
+    uint64_t rows;
+    std::vector<Reject> rejects;
+};
+
+inline bool isBlank(const char* begin, const char* end) {
+    for (; begin < end; begin++) {
+        if (!coordinate_detail::isSpace(*begin)) return false;
+    }
+    return true;
+}
+
+// Finds the value of "key" in a flat JSON object, up to the next ',' or '}'
+inline bool findJsonValue(const char* begin, const char* end, const char* key, size_t keyLength,
+                          const char*& valueBegin, const char*& valueEnd) {
+    for (const char* p = begin; p + keyLength + 2 <= end; p++) {
+        p = static_cast<const char*>(std::memchr(p, '"', static_cast<size_t>(end - p)));
+        if (p == nullptr || p + keyLength + 2 > end) return false;
+        if (std::memcmp(p + 1, key, keyLength) != 0 || p[keyLength + 1] != '"') continue;
+        const char* q = p + keyLength + 2;
+        while (q < end && coordinate_detail::isSpace(*q)) q++;
+        if (q == end || *q != ':') continue;
+        valueBegin = ++q;
+        while (q < end && *q != ',' && *q != '}') q++;
+        valueEnd = q;
+        return true;
+    }
+    return false;
+}
+
+// Parses and validates one field; the error is MissingField if absent
+template <class Field>
+CoordinateError checkField(const char* begin, const char* end, bool found) {
+    if (!found) return CoordinateError::MissingField;
+    double value;
+    ValidationResult result = parseCoordinate(begin, end, value);
+    if (result.isValid) result = Validator<Field>::validate(value);
+    return result.error;
+}
+
+inline void checkRow(const char* begin, const char* end, bool ndjson, uint64_t line, Chunk& chunk) {
+    const char* latBegin = begin;
+    const char* latEnd = end;
+    const char* lonBegin = end;
+    const char* lonEnd = end;
+    bool hasLat = true, hasLon;
+    if (ndjson) {
+        hasLat = findJsonValue(begin, end, "lat", 3, latBegin, latEnd);
+        hasLon = findJsonValue(begin, end, "lon", 3, lonBegin, lonEnd);
+    } else {
+        const char* comma = static_cast<const char*>(std::memchr(begin, ',', static_cast<size_t>(end - begin)));
+        hasLon = comma != nullptr;
+        if (hasLon) {
+            latEnd = comma;
+            lonBegin = comma + 1;
+        }
+    }
+
+    chunk.rows++;
+    CoordinateError error = checkField<Latitude>(latBegin, latEnd, hasLat);
+    bool longitude = false;
+    if (error == CoordinateError::None) {
+        error = checkField<Longitude>(lonBegin, lonEnd, hasLon);
+        longitude = true;
+    }
+    if (error != CoordinateError::None) {
+        Reject reject = { line, error, longitude };
+        chunk.rejects.push_back(reject);
+    }
+}
+
+// A CSV header field: lat, latitude, lon, lng, long or longitude in any
+// case, optionally quoted and padded with whitespace
+inline bool isHeaderName(const char* begin, const char* end) {
+    while (begin < end && coordinate_detail::isSpace(*begin)) begin++;
+    while (end > begin && coordinate_detail::isSpace(end[-1])) end--;
+    if (end - begin >= 2 && *begin == '"' && end[-1] == '"') {
+        begin++;
+        end--;
+    }
+    static const char* const names[] = { "lat", "latitude", "lon", "lng", "long", "longitude" };
+    for (size_t n = 0; n < sizeof(names) / sizeof(names[0]); n++) {
+        const char* name = names[n];
+        const char* p = begin;
+        while (p < end && *name != '\0' && std::tolower(static_cast<unsigned char>(*p)) == *name) {
+            p++;
+            name++;
+        }
+        if (p == end && *name == '\0') return true;
+    }
+    return false;
+}
+
+// True if the line at line is a header: both fields are column names, so
+// a malformed first row such as "inf,0" or "abc,5" is still validated
+inline bool isCsvHeader(const char* line, const char* end) {
+    const char* lineEnd = static_cast<const char*>(std::memchr(line, '\n', static_cast<size_t>(end - line)));
+    if (lineEnd == nullptr) lineEnd = end;
+    const char* comma = static_cast<const char*>(std::memchr(line, ',', static_cast<size_t>(lineEnd - line)));
+    return comma != nullptr && isHeaderName(line, comma) && isHeaderName(comma + 1, lineEnd);
+}
+
+// header, if not null, points into the CSV header line, which is skipped
+inline void checkChunk(Chunk& chunk, bool ndjson, const char* header) {
+    const char* p = chunk.begin;
+    uint64_t line = 0;
+    while (p < chunk.end) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(chunk.end - p)));
+        const char* lineEnd = newline != nullptr ? newline : chunk.end;
+        bool isHeader = header != nullptr && header >= p && header < lineEnd;
+        if (!isHeader && !isBlank(p, lineEnd)) checkRow(p, lineEnd, ndjson, line, chunk);
+        line++;
+        p = lineEnd + 1;
+    }
+    chunk.lines = line;
+}
+
+inline const char* fieldName(const Reject& reject) {
+    return reject.longitude ? "Longitude" : "Latitude";
+}
+
+} // namespace coordinate_file_detail
+
+// Validates the file at path and fills report. If rejectPath is given, every
+// rejected row is written there in file order as
+// "<line number>\t<field>\t<reason>", with lines numbered from 1. The file is
+// memory-mapped and split into newline-aligned chunks that worker threads
+// take in turn. The first non-blank line of a CSV file is skipped as a
+// header only if both of its fields are column names (see isHeaderName);
+// any other first line is validated like the rest. Returns false, with report.error set to the
+// errno, if the file cannot be mapped or the reject file cannot be written;
+// the counts are still filled in when only the reject file failed.
+inline bool validateCoordinateFile(const char* path, const CoordinateFileOptions& options,
+                                   CoordinateFileReport& report, const char* rejectPath = nullptr) {
+    using namespace coordinate_file_detail;
+    report = CoordinateFileReport();
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        report.error = errno;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        report.error = errno;
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    void* mapping = nullptr;
+    if (size > 0) {
+        mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            report.error = errno;
+            ::close(fd);
+            return false;
+        }
+        madvise(mapping, size, MADV_SEQUENTIAL);
+    }
+    ::close(fd);
+    const char* data = static_cast<const char*>(mapping);
+    const char* end = data + size;
+
+    const char* first = data;
+    while (first < end && coordinate_detail::isSpace(*first)) first++;
+    bool ndjson = options.format == CoordinateFileFormat::Ndjson ||
+                  (options.format == CoordinateFileFormat::Auto && first < end && *first == '{');
+    const char* header = !ndjson && first < end && isCsvHeader(first, end) ? first : nullptr;
+
+    std::vector<Chunk> chunks;
+    size_t chunkBytes = options.chunkBytes > 0 ? options.chunkBytes : 1;
+    for (const char* begin = data; begin < end;) {
+        const char* stop = static_cast<size_t>(end - begin) > chunkBytes ? begin + chunkBytes : end;
+        if (stop < end) {
+            const char* newline = static_cast<const char*>(std::memchr(stop, '\n', static_cast<size_t>(end - stop)));
+            stop = newline != nullptr ? newline + 1 : end;
+        }
+        Chunk chunk;
+        chunk.begin = begin;
+        chunk.end = stop;
+        chunk.lines = 0;
+        chunk.rows = 0;
+        chunks.push_back(chunk);
+        begin = stop;
+    }
+
+    unsigned threads = options.threads != 0 ? options.threads : std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    if (threads > chunks.size()) threads = static_cast<unsigned>(chunks.size());
+    std::atomic<size_t> next(0);
+    auto work = [&]() {
+        for (size_t i; (i = next.fetch_add(1)) < chunks.size();) {
+            checkChunk(chunks[i], ndjson, header);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; t++) workers.push_back(std::thread(work));
+    work();
+    for (size_t t = 0; t < workers.size(); t++) workers[t].join();
+
+    FILE* out = rejectPath != nullptr ? std::fopen(rejectPath, "w") : nullptr;
+    if (rejectPath != nullptr && out == nullptr) report.error = errno;
+    uint64_t firstLine = 1;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        const Chunk& chunk = chunks[i];
+        report.rows += chunk.rows;
+        report.rejected += chunk.rejects.size();
+        // Writing stops at the first failed fprintf. errno is cleared first
+        // so a value left by an earlier call is never reported.
+        for (size_t r = 0; out != nullptr && report.error == 0 && r < chunk.rejects.size(); r++) {
+            const Reject& reject = chunk.rejects[r];
+            ValidationResult result = ValidationResult::failure(reject.error, fieldName(reject));
+            if (reject.error == CoordinateError::OutOfRange) {
+                result.min = reject.longitude ? MIN_LON : MIN_LAT;
+                result.max = reject.longitude ? MAX_LON : MAX_LAT;
+            }
+            char message[128];
+            result.formatMessage(message, sizeof(message));
+            errno = 0;
+            if (std::fprintf(out, "%llu\t%s\t%s\n", static_cast<unsigned long long>(firstLine + reject.line),
+                             fieldName(reject), message) < 0) {
+                report.error = errno != 0 ? errno : EIO;
+            }
+        }
+        firstLine += chunk.lines;
+    }
+    if (out != nullptr) {
+        errno = 0;
+        if (std::fclose(out) != 0 && report.error == 0) report.error = errno != 0 ? errno : EIO;
+    }
+    report.bytes = size;
+    report.valid = report.rows - report.rejected;
+
+    if (mapping != nullptr) munmap(mapping, size);
+    return report.error == 0;
+}
+
+#endif // COORDINATE_FILE_H
@@ -0,0 +1,198 @@
+#ifndef COORDINATE_INDEX_H
+#define COORDINATE_INDEX_H
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "coordinate.h"
+#include "coordinate_validator.h"
+
+// Mean Earth radius used for all great-circle distances
+constexpr double EARTH_RADIUS_KM = 6371.0088;
+
+namespace coordinate_index_detail {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double RADIANS = PI / 180.0;
+
+inline double square(double x) { return x * x; }
+
+// sin^2 of half the central angle between two points, in degrees
+inline double haversine(double lat1, double lon1, double lat2, double lon2) {
+    return square(std::sin((lat2 - lat1) * RADIANS / 2)) +
+           std::cos(lat1 * RADIANS) * std::cos(lat2 * RADIANS) * square(std::sin((lon2 - lon1) * RADIANS / 2));
+}
+
+// Maps a longitude onto [-180, 180), so +180 and -180 become one meridian
+inline double wrapLongitude(double lon) {
+    lon = std::fmod(lon + 180.0, 360.0);
+    if (lon < 0) lon += 360.0;
+    return lon - 180.0;
+}
+
+} // namespace coordinate_index_detail
+
+// Great-circle distance in kilometres between two points in degrees
+inline double haversineKm(double lat1, double lon1, double lat2, double lon2) {
+    double h = coordinate_index_detail::haversine(lat1, lon1, lat2, lon2);
+    return 2 * EARTH_RADIUS_KM * std::asin(std::sqrt(std::min(h, 1.0)));
+}
+
+// A latitude/longitude box with inclusive edges. west > east means the box
+// crosses the antimeridian (west = 170, east = -170 spans 20 degrees), and
+// an east - west of 360 or more covers every longitude.
+struct CoordinateBox {
+    double south, west, north, east;
+};
+
+// Static index over points that pass validation, answering box and radius
+// queries. Points are stored in one array arranged as an implicit k-d tree
+// (alternating longitude and latitude splits around the median, down to
+// buckets of leafSize points), so it is bulk-built in O(n log n) with
+// nth_element and queried without any pointers. Query results are the
+// positions of the points in the arrays the index was built from, in no
+// particular order.
+class CoordinateIndex {
+public:
+    // Indexes latitudes[i], longitudes[i] for i < count, skipping points
+    // that Validator<Latitude> or Validator<Longitude> reject. Ids are 32-bit,
+    // so positions from 2^32 on are not indexed and count as rejected.
+    // Longitudes are stored wrapped onto [-180, 180).
+    CoordinateIndex(const double* latitudes, const double* longitudes, size_t count, size_t leafSize = 64)
+        : leafSize_(leafSize > 0 ? leafSize : 1) {
+        size_t indexed = static_cast<uint64_t>(count) > MAX_POINTS ? static_cast<size_t>(MAX_POINTS) : count;
+        points_.reserve(indexed);
+        for (size_t i = 0; i < indexed; i++) {
+            if (!Validator<Latitude>::accepts(latitudes[i]) || !Validator<Longitude>::accepts(longitudes[i])) continue;
+            Point point = { latitudes[i], coordinate_index_detail::wrapLongitude(longitudes[i]),
+                            static_cast<uint32_t>(i) };
+            points_.push_back(point);
+        }
+        rejected_ = count - points_.size();
+        if (!points_.empty()) build(0, points_.size() - 1, 0, 0);
+    }
+
+    size_t size() const { return points_.size(); }
+    size_t rejected() const { return rejected_; }
+    size_t memoryBytes() const { return sizeof(*this) + points_.capacity() * sizeof(Point); }
+
+    // Appends the ids of the points inside box to out
+    void queryBox(const CoordinateBox& box, std::vector<uint32_t>& out) const {
+        visitBox(box, [&](const Point& point) { out.push_back(point.id); });
+    }
+
+    // Appends the ids of the points within radiusKm (great-circle) of the
+    // centre to out. The search covers the circle's bounding box, which
+    // spans every longitude when the circle reaches a pole.
+    void queryRadius(double lat, double lon, double radiusKm, std::vector<uint32_t>& out) const {
+        using namespace coordinate_index_detail;
+        double angle = radiusKm / EARTH_RADIUS_KM;
+        if (angle < 0) return;
+        double limit = angle >= PI ? 1.0 : square(std::sin(angle / 2));
+        double degrees = angle / RADIANS;
+        // Rounding slack so points on the circle are never cut off by the box
+        const double slack = 1e-9;
+        CoordinateBox box = { lat - degrees - slack, -180.0, lat + degrees + slack, 180.0 };
+        if (box.south > MIN_LAT && box.north < MAX_LAT) {
+            // Meridians tangent to the circle
+            double spread = std::asin(std::min(1.0, std::sin(angle) / std::cos(lat * RADIANS))) / RADIANS;
+            box.west = lon - spread - slack;
+            box.east = lon + spread + slack;
+        }
+        visitBox(box, [&](const Point& point) {
+            if (haversine(lat, lon, point.lat, point.lon) <= limit) out.push_back(point.id);
+        });
+    }
+
+private:
+    static constexpr uint64_t MAX_POINTS = uint64_t(1) << 32;
+    // Each split at least halves a range, so MAX_POINTS points need at most
+    // 32 levels of splits, and a walk holds one pending range per level
+    static const size_t MAX_DEPTH = 32;
+
+    struct Point {
+        double lat;
+        double lon;
+        uint32_t id;
+    };
+
+    // A contiguous part of points_ whose median splits on axis (0 = lon)
+    struct Range {
+        size_t left, right;
+        int axis;
+    };
+
+    static double key(const Point& point, int axis) { return axis == 0 ? point.lon : point.lat; }
+
+    void build(size_t left, size_t right, int axis, size_t depth) {
+        if (right - left < leafSize_) return;
+        assert(depth < MAX_DEPTH && "more split levels than visitRange has stack");
+        size_t middle = left + (right - left) / 2;
+        std::nth_element(points_.begin() + left, points_.begin() + middle, points_.begin() + right + 1,
+                         [axis](const Point& a, const Point& b) { return key(a, axis) < key(b, axis); });
+        if (middle > left) build(left, middle - 1, 1 - axis, depth + 1);
+        build(middle + 1, right, 1 - axis, depth + 1);
+    }
+
+    // Calls visit for every point inside box. A box crossing the antimeridian
+    // is searched as two longitude ranges.
+    template <class Visit>
+    void visitBox(const CoordinateBox& box, Visit visit) const {
+        double span = box.east - box.west;
+        if (span < 0) span += 360.0;
+        if (span >= 360.0) {
+            visitRange(box.south, box.north, -180.0, 180.0, visit);
+            return;
+        }
+        double west = coordinate_index_detail::wrapLongitude(box.west);
+        double east = west + span;
+        if (east < 180.0) {
+            visitRange(box.south, box.north, west, east, visit);
+        } else {
+            visitRange(box.south, box.north, west, 180.0, visit);
+            visitRange(box.south, box.north, -180.0, east - 360.0, visit);
+        }
+    }
+
+    template <class Visit>
+    void visitRange(double south, double north, double west, double east, Visit& visit) const {
+        if (points_.empty() || south > north) return;
+        Range stack[MAX_DEPTH + 1];
+        size_t top = 0;
+        Range all = { 0, points_.size() - 1, 0 };
+        stack[top++] = all;
+        while (top > 0) {
+            Range range = stack[--top];
+            if (range.right - range.left < leafSize_) {
+                for (size_t i = range.left; i <= range.right; i++) {
+                    const Point& point = points_[i];
+                    if (point.lat >= south && point.lat <= north && point.lon >= west && point.lon <= east) visit(point);
+                }
+                continue;
+            }
+            size_t middle = range.left + (range.right - range.left) / 2;
+            const Point& point = points_[middle];
+            if (point.lat >= south && point.lat <= north && point.lon >= west && point.lon <= east) visit(point);
+            double lo = range.axis == 0 ? west : south;
+            double hi = range.axis == 0 ? east : north;
+            double split = key(point, range.axis);
+            if (lo <= split && middle > range.left) {
+                Range below = { range.left, middle - 1, 1 - range.axis };
+                stack[top++] = below;
+            }
+            if (hi >= split) {
+                Range above = { middle + 1, range.right, 1 - range.axis };
+                stack[top++] = above;
+            }
+        }
+    }
+
+    std::vector<Point> points_;
+    size_t leafSize_;
+    size_t rejected_;
+};
+
+#endif // COORDINATE_INDEX_H
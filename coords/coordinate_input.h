@@ -0,0 +1,113 @@
+#ifndef COORDINATE_INPUT_H
+#define COORDINATE_INPUT_H
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "coordinate.h"
+
+// Non-interactive input: coordinates read line by line from a pipe or file
+// descriptor without iostreams and without copying each line into a
+// std::string. The interactive getInput in coordinate.h is unchanged.
+
+// One line of input, without its '\n'. It points into the reader's buffer
+// and is only valid until the next call to next().
+struct CoordinateLine {
+    const char* begin;
+    const char* end;
+
+    size_t size() const { return static_cast<size_t>(end - begin); }
+    std::string str() const { return std::string(begin, end); }
+};
+
+// Reads blocks of blockBytes with read(2) and splits them with memchr. A
+// line that does not fit in the buffer grows it, so the buffer ends up as
+// large as the longest line. Unlike getline on std::cin, a last line
+// without a trailing newline is returned as a normal line.
+class CoordinateLineReader {
+public:
+    explicit CoordinateLineReader(int fd, size_t blockBytes = 64 << 10)
+        : fd_(fd), buffer_(blockBytes > 0 ? blockBytes : 1), begin_(0), scanned_(0), end_(0),
+          eof_(false), failed_(false) {}
+
+    // Returns false once the input is exhausted or a read fails
+    bool next(CoordinateLine& line) {
+        for (;;) {
+            const char* data = buffer_.data();
+            const void* newline = std::memchr(data + scanned_, '\n', end_ - scanned_);
+            if (newline != nullptr) {
+                line.begin = data + begin_;
+                line.end = static_cast<const char*>(newline);
+                begin_ = scanned_ = static_cast<size_t>(line.end - data) + 1;
+                return true;
+            }
+            scanned_ = end_;
+            if (eof_) {
+                if (begin_ == end_) return false;
+                line.begin = data + begin_;
+                line.end = data + end_;
+                begin_ = end_;
+                return true;
+            }
+            fill();
+        }
+    }
+
+    // True if reading stopped because read(2) failed rather than at end of input
+    bool failed() const { return failed_; }
+
+private:
+    // Moves the unfinished line to the front and reads after it
+    void fill() {
+        if (begin_ > 0) {
+            std::memmove(&buffer_[0], &buffer_[begin_], end_ - begin_);
+            scanned_ -= begin_;
+            end_ -= begin_;
+            begin_ = 0;
+        }
+        if (end_ == buffer_.size()) buffer_.resize(buffer_.size() * 2);
+        ssize_t count;
+        do {
+            count = ::read(fd_, &buffer_[end_], buffer_.size() - end_);
+        } while (count < 0 && errno == EINTR);
+        if (count <= 0) {
+            eof_ = true;
+            failed_ = count < 0;
+        } else {
+            end_ += static_cast<size_t>(count);
+        }
+    }
+
+    int fd_;
+    std::vector<char> buffer_;
+    size_t begin_;     // start of the next line
+    size_t scanned_;   // bytes before this hold no newline of the next line
+    size_t end_;       // end of the bytes read so far
+    bool eof_;
+    bool failed_;
+};
+
+// getInput reading from a CoordinateLineReader: the same prompt, error
+// messages, three attempts, MaxAttempts and InputStream results, but each
+// line is parsed in place. Running out of input or a failed read is an
+// InputStream error, like a bad std::cin.
+inline ValidationResult getInput(CoordinateLineReader& input, const std::string& prompt, double& value) {
+    for (int attempts = 0; attempts < 3; ++attempts) {
+        std::cout << prompt;
+        CoordinateLine line;
+        if (!input.next(line)) return ValidationResult::failure(CoordinateError::InputStream);
+
+        ValidationResult result = parseCoordinate(line.begin, line.end, value);
+        if (result.isValid) return ValidationResult::success();
+        char message[128];
+        result.formatMessage(message, sizeof(message));
+        std::cout << "Error: " << message << "\n";
+    }
+    return ValidationResult::failure(CoordinateError::MaxAttempts);
+}
+
+#endif // COORDINATE_INPUT_H
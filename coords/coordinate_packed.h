@@ -0,0 +1,200 @@
+#ifndef COORDINATE_PACKED_H
+#define COORDINATE_PACKED_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "coordinate.h"
+#include "coordinate_batch.h"
+
+// Compact storage for validated coordinates: each degree value becomes a
+// 32-bit integer count of 1e-7 degrees ("E7", about 1.1 cm at the equator),
+// so a point takes 8 bytes instead of 16. Every value validateCoordinate
+// accepts, including the EPSILON slack past +-180, fits an int32_t.
+// Decoding divides by 1e7, so values printed with at most seven decimals
+// decode to exactly the double that parsing the text gives.
+
+constexpr double PACKED_UNITS_PER_DEGREE = 1e7;
+
+struct PackedCoordinate {
+    int32_t lat;
+    int32_t lon;
+};
+
+// Rounds to the nearest unit, ties to even. value must be a finite degree
+// value in [-180 - EPSILON, 180 + EPSILON].
+inline int32_t encodeDegrees(double value) {
+    return static_cast<int32_t>(std::nearbyint(value * PACKED_UNITS_PER_DEGREE));
+}
+
+inline double decodeDegrees(int32_t units) {
+    return units / PACKED_UNITS_PER_DEGREE;
+}
+
+namespace coordinate_packed_detail {
+
+inline void encodeScalar(const double* lat, const double* lon, size_t count, PackedCoordinate* out) {
+    for (size_t i = 0; i < count; i++) {
+        out[i].lat = encodeDegrees(lat[i]);
+        out[i].lon = encodeDegrees(lon[i]);
+    }
+}
+
+inline void decodeScalar(const PackedCoordinate* in, size_t count, double* lat, double* lon) {
+    for (size_t i = 0; i < count; i++) {
+        lat[i] = decodeDegrees(in[i].lat);
+        lon[i] = decodeDegrees(in[i].lon);
+    }
+}
+
+#if COORDINATE_BATCH_X86
+// The conversions round with the current rounding mode (nearest even by
+// default), as nearbyint does, so every level gives identical results.
+__attribute__((target("avx2")))
+inline void encodeAvx2(const double* lat, const double* lon, size_t count, PackedCoordinate* out) {
+    const __m256d scale = _mm256_set1_pd(PACKED_UNITS_PER_DEGREE);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i la = _mm256_cvtpd_epi32(_mm256_mul_pd(_mm256_loadu_pd(lat + i), scale));
+        __m128i lo = _mm256_cvtpd_epi32(_mm256_mul_pd(_mm256_loadu_pd(lon + i), scale));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi32(la, lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 2), _mm_unpackhi_epi32(la, lo));
+    }
+    encodeScalar(lat + i, lon + i, count - i, out + i);
+}
+
+__attribute__((target("avx2")))
+inline void decodeAvx2(const PackedCoordinate* in, size_t count, double* lat, double* lon) {
+    const __m256d scale = _mm256_set1_pd(PACKED_UNITS_PER_DEGREE);
+    const __m256i split = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i packed = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        packed = _mm256_permutevar8x32_epi32(packed, split);
+        _mm256_storeu_pd(lat + i, _mm256_div_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(packed)), scale));
+        _mm256_storeu_pd(lon + i, _mm256_div_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(packed, 1)), scale));
+    }
+    decodeScalar(in + i, count - i, lat + i, lon + i);
+}
+
+COORDINATE_AVX512_DIAGNOSTICS_PUSH
+__attribute__((target("avx512f")))
+inline void encodeAvx512(const double* lat, const double* lon, size_t count, PackedCoordinate* out) {
+    const __m512d scale = _mm512_set1_pd(PACKED_UNITS_PER_DEGREE);
+    const __m512i interleave = _mm512_setr_epi32(0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i la = _mm512_cvtpd_epi32(_mm512_mul_pd(_mm512_loadu_pd(lat + i), scale));
+        __m256i lo = _mm512_cvtpd_epi32(_mm512_mul_pd(_mm512_loadu_pd(lon + i), scale));
+        __m512i both = _mm512_inserti64x4(_mm512_castsi256_si512(la), lo, 1);
+        _mm512_storeu_si512(out + i, _mm512_permutexvar_epi32(interleave, both));
+    }
+    encodeScalar(lat + i, lon + i, count - i, out + i);
+}
+
+__attribute__((target("avx512f")))
+inline void decodeAvx512(const PackedCoordinate* in, size_t count, double* lat, double* lon) {
+    const __m512d scale = _mm512_set1_pd(PACKED_UNITS_PER_DEGREE);
+    const __m512i split = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m512i packed = _mm512_permutexvar_epi32(split, _mm512_loadu_si512(in + i));
+        _mm512_storeu_pd(lat + i, _mm512_div_pd(_mm512_cvtepi32_pd(_mm512_castsi512_si256(packed)), scale));
+        _mm512_storeu_pd(lon + i, _mm512_div_pd(_mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(packed, 1)), scale));
+    }
+    decodeScalar(in + i, count - i, lat + i, lon + i);
+}
+COORDINATE_AVX512_DIAGNOSTICS_POP
+#endif
+
+inline uint32_t zigzag(int32_t delta) {
+    return (static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31);
+}
+
+inline int32_t unzigzag(uint32_t value) {
+    return static_cast<int32_t>((value >> 1) ^ (0u - (value & 1)));
+}
+
+inline void putVarint(uint32_t value, std::vector<uint8_t>& out) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+inline bool getVarint(const uint8_t*& p, const uint8_t* end, uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35 && p < end; shift += 7) {
+        uint8_t byte = *p++;
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if (byte < 0x80) return true;
+    }
+    return false;
+}
+
+} // namespace coordinate_packed_detail
+
+// Packs count points from separate latitude and longitude arrays, which
+// must hold validated values. simd is lowered to what the CPU supports.
+inline void encodeCoordinates(const double* latitudes, const double* longitudes, size_t count,
+                              PackedCoordinate* out, CoordinateSimd simd = detectCoordinateSimd()) {
+    using namespace coordinate_packed_detail;
+    CoordinateSimd best = detectCoordinateSimd();
+    if (static_cast<int>(simd) > static_cast<int>(best)) simd = best;
+#if COORDINATE_BATCH_X86
+    if (simd == CoordinateSimd::Avx512) encodeAvx512(latitudes, longitudes, count, out);
+    else if (simd == CoordinateSimd::Avx2) encodeAvx2(latitudes, longitudes, count, out);
+    else encodeScalar(latitudes, longitudes, count, out);
+#else
+    encodeScalar(latitudes, longitudes, count, out);
+#endif
+}
+
+inline void decodeCoordinates(const PackedCoordinate* in, size_t count, double* latitudes, double* longitudes,
+                              CoordinateSimd simd = detectCoordinateSimd()) {
+    using namespace coordinate_packed_detail;
+    CoordinateSimd best = detectCoordinateSimd();
+    if (static_cast<int>(simd) > static_cast<int>(best)) simd = best;
+#if COORDINATE_BATCH_X86
+    if (simd == CoordinateSimd::Avx512) decodeAvx512(in, count, latitudes, longitudes);
+    else if (simd == CoordinateSimd::Avx2) decodeAvx2(in, count, latitudes, longitudes);
+    else decodeScalar(in, count, latitudes, longitudes);
+#else
+    decodeScalar(in, count, latitudes, longitudes);
+#endif
+}
+
+// Appends a track (points in travel order) to out as zigzag varints of the
+// differences between consecutive points, starting from (0, 0). Points a
+// few metres apart take 2 to 4 bytes instead of 8.
+inline void encodeTrack(const PackedCoordinate* points, size_t count, std::vector<uint8_t>& out) {
+    using namespace coordinate_packed_detail;
+    PackedCoordinate previous = { 0, 0 };
+    for (size_t i = 0; i < count; i++) {
+        // Wrapping subtraction; the sum in decodeTrack wraps back
+        putVarint(zigzag(static_cast<int32_t>(static_cast<uint32_t>(points[i].lat) - static_cast<uint32_t>(previous.lat))), out);
+        putVarint(zigzag(static_cast<int32_t>(static_cast<uint32_t>(points[i].lon) - static_cast<uint32_t>(previous.lon))), out);
+        previous = points[i];
+    }
+}
+
+// Appends the points of an encoded track to out. Returns false, keeping
+// the points decoded so far, if the data ends inside a point.
+inline bool decodeTrack(const uint8_t* data, size_t size, std::vector<PackedCoordinate>& out) {
+    using namespace coordinate_packed_detail;
+    const uint8_t* p = data;
+    const uint8_t* end = data + size;
+    PackedCoordinate point = { 0, 0 };
+    while (p < end) {
+        uint32_t lat, lon;
+        if (!getVarint(p, end, lat) || !getVarint(p, end, lon)) return false;
+        point.lat = static_cast<int32_t>(static_cast<uint32_t>(point.lat) + static_cast<uint32_t>(unzigzag(lat)));
+        point.lon = static_cast<int32_t>(static_cast<uint32_t>(point.lon) + static_cast<uint32_t>(unzigzag(lon)));
+        out.push_back(point);
+    }
+    return true;
+}
+
+#endif // COORDINATE_PACKED_H
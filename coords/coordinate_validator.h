@@ -0,0 +1,80 @@
+#ifndef COORDINATE_VALIDATOR_H
+#define COORDINATE_VALIDATOR_H
+
+#include <cmath>
+#include "coordinate.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define COORDINATE_COLD __attribute__((noinline, cold))
+#else
+#define COORDINATE_COLD
+#endif
+
+// Validation with the bounds fixed at compile time. A field type supplies
+// its range and name as constexpr functions:
+//
+//     struct Depth {
+//         static constexpr double min() { return 0.0; }
+//         static constexpr double max() { return 11000.0; }
+//         static constexpr const char* name() { return "Depth"; }
+//     };
+//
+// Validator<Depth>::validate(value) then inlines to two compares against
+// folded constants; the name is only touched when the value is rejected.
+
+struct Latitude {
+    static constexpr double min() { return MIN_LAT; }
+    static constexpr double max() { return MAX_LAT; }
+    static constexpr const char* name() { return "Latitude"; }
+};
+
+struct Longitude {
+    static constexpr double min() { return MIN_LON; }
+    static constexpr double max() { return MAX_LON; }
+    static constexpr const char* name() { return "Longitude"; }
+};
+
+// Metres relative to sea level, from the Dead Sea shore to above airliners
+struct Altitude {
+    static constexpr double min() { return -500.0; }
+    static constexpr double max() { return 20000.0; }
+    static constexpr const char* name() { return "Altitude"; }
+};
+
+// Degrees clockwise from north
+struct Bearing {
+    static constexpr double min() { return 0.0; }
+    static constexpr double max() { return 360.0; }
+    static constexpr const char* name() { return "Bearing"; }
+};
+
+template <class Field>
+struct Validator {
+    static_assert(Field::min() <= Field::max(), "field range is empty");
+
+    // The accepted interval, widened by EPSILON like validateCoordinate
+    static constexpr double lower() { return Field::min() - EPSILON; }
+    static constexpr double upper() { return Field::max() + EPSILON; }
+
+    // Same answer as validateCoordinate(value, min, max, name).isValid, with
+    // one pair of compares: NaN and the infinities fail them too, and only
+    // reject() tells NotFinite from OutOfRange.
+    static constexpr bool accepts(double value) {
+        return value >= lower() && value <= upper();
+    }
+
+    static ValidationResult validate(double value) {
+        return accepts(value) ? ValidationResult::success() : reject(value);
+    }
+
+private:
+    COORDINATE_COLD static ValidationResult reject(double value) {
+        if (!std::isfinite(value)) {
+            return ValidationResult::failure(CoordinateError::NotFinite, Field::name(), value);
+        }
+        return ValidationResult::failure(CoordinateError::OutOfRange, Field::name(), value,
+                                         Field::min(), Field::max());
+    }
+};
+
+#endif // COORDINATE_VALIDATOR_H
@@ -5,66 +5,22 @@
 #include <iomanip>
 #include <sstream>
 #include <cassert>
+#include <random>
+#include "coordinate.h"
+#include "coordinate_batch.h"
+#include "coordinate_file.h"
+#include "coordinate_validator.h"
+#include "coordinate_index.h"
+#include "coordinate_packed.h"
+#include "coordinate_input.h"
+#include "coordinate_distance.h"
+#include <algorithm>
+#include <fstream>
+#include <cerrno>
 
-const double MIN_LAT = -90.0, MAX_LAT = 90.0;
-const double MIN_LON = -180.0, MAX_LON = 180.0;
-const double EPSILON = 1e-10;
-
-struct ValidationResult {
-    bool isValid;
-    std::string message;
-    ValidationResult(bool valid, const std::string& msg = "") 
-        : isValid(valid), message(msg) {}
-};
-
-ValidationResult parseCoordinate(const std::string& input, double& result) {
-    if (input.empty() || input.length() > 50) {
-        return ValidationResult(false, "Invalid input length");
-    }
-    
-    std::istringstream iss(input);
-    if (!(iss >> result) || iss >> std::ws && !iss.eof()) {
-        return ValidationResult(false, "Invalid number format");
-    }
-    
-    if (!std::isfinite(result)) {
-        return ValidationResult(false, "Invalid value (infinity or NaN)");
-    }
-    
-    return ValidationResult(true);
-}
-
-ValidationResult getInput(const std::string& prompt, double& value) {
-    for (int attempts = 0; attempts < 3; ++attempts) {
-        std::cout << prompt;
-        std::string input;
-        std::getline(std::cin, input);
-        
-        if (!std::cin.good()) {
-            std::cin.clear();
-            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-            return ValidationResult(false, "Input stream error");
-        }
-        
-        ValidationResult result = parseCoordinate(input, value);
-        if (result.isValid) return ValidationResult(true);
-        std::cout << "Error: " << result.message << "\n";
-    }
-    return ValidationResult(false, "Max attempts exceeded");
-}
-
-ValidationResult validateCoordinate(double value, double min, double max, 
-                                  const std::string& type) {
-    if (!std::isfinite(value)) {
-        return ValidationResult(false, type + " must be finite");
-    }
-    if (value < min - EPSILON || value > max + EPSILON) {
-        std::ostringstream oss;
-        oss << type << " must be between " << min << " and " << max;
-        return ValidationResult(false, oss.str());
-    }
-    return ValidationResult(true);
-}
+// runTests checks everything with assert, so built with -DNDEBUG it only
+// exercises the code and checks nothing. fuzz_coords.cpp keeps its checks
+// under NDEBUG.
 
 void runTests() {
     std::cout << "\nRunning validation tests...\n";
@@ -113,6 +69,393 @@ void runTests() {
         }
     }
     
+    // Test 5: Fast parser matches the istringstream reference
+    {
+        std::mt19937 rng(16);
+        const char alphabet[] = "0123456789+-.eE \t\nx";
+        for (int i = 0; i < 200000; ++i) {
+            std::string input;
+            if (i % 2) {
+                // Well-formed numbers across the whole double range
+                std::ostringstream oss;
+                oss << std::setprecision(1 + rng() % 17)
+                    << std::ldexp(static_cast<double>(rng()) - 2147483648.0, static_cast<int>(rng() % 2100) - 1100);
+                input = oss.str();
+            } else {
+                size_t length = rng() % 12;
+                for (size_t k = 0; k < length; ++k) input += alphabet[rng() % (sizeof(alphabet) - 1)];
+            }
+            double fast = 0, reference = 0;
+            ValidationResult a = parseCoordinate(input, fast);
+            ValidationResult b = parseCoordinateReference(input, reference);
+            assert(a.isValid == b.isValid && a.error == b.error && "FAIL: Parsers disagree");
+            assert((!a.isValid || std::memcmp(&fast, &reference, sizeof(double)) == 0) &&
+                   "FAIL: Parsers produce different values");
+        }
+    }
+
+    // Test 6: Batch validation matches validateCoordinate at every SIMD level
+    {
+        const double inf = std::numeric_limits<double>::infinity();
+        const double special[] = {
+            0.0, -0.0, MIN_LAT, MAX_LAT, MIN_LON, MAX_LON, MIN_LAT - EPSILON * 2, MAX_LON + EPSILON * 2,
+            MAX_LAT + EPSILON / 2, inf, -inf, std::numeric_limits<double>::quiet_NaN(), 1e300, -1e-300
+        };
+        const size_t count = 1003;  // not a multiple of 64, so the tail is exercised
+        std::vector<double> lat(count), lon(count);
+        std::mt19937 rng(17);
+        for (size_t i = 0; i < count; ++i) {
+            lat[i] = rng() % 4 ? std::ldexp(static_cast<double>(rng()), -25) - 64.0 : special[rng() % 14];
+            lon[i] = rng() % 4 ? std::ldexp(static_cast<double>(rng()), -23) - 256.0 : special[rng() % 14];
+        }
+        const CoordinateSimd levels[] = { CoordinateSimd::Scalar, CoordinateSimd::Avx2, CoordinateSimd::Avx512 };
+        for (CoordinateSimd simd : levels) {
+            std::vector<uint64_t> bits((count + 63) / 64);
+            size_t invalid = validateCoordinates(lat.data(), lon.data(), count, bits.data(), simd);
+            size_t expectedInvalid = 0;
+            for (size_t i = 0; i < count; ++i) {
+                bool expected = validateCoordinate(lat[i], MIN_LAT, MAX_LAT, "Latitude").isValid &&
+                                validateCoordinate(lon[i], MIN_LON, MAX_LON, "Longitude").isValid;
+                if (!expected) expectedInvalid++;
+                assert(((bits[i / 64] >> (i % 64)) & 1) == expected && "FAIL: Batch validity bit is wrong");
+            }
+            assert(invalid == expectedInvalid && "FAIL: Batch invalid count is wrong");
+            assert(bits.back() >> (count % 64) == 0 && "FAIL: Unused bits are set");
+
+            std::vector<CoordinateFailure> failures;
+            describeInvalidCoordinates(lat.data(), lon.data(), count, bits.data(), failures);
+            assert(failures.size() == invalid && !failures.empty() && !failures[0].result.isValid &&
+                   "FAIL: Failure details do not match");
+        }
+    }
+
+    // Test 7: Results carry codes; messages are formatted on request
+    {
+        ValidationResult result = validateCoordinate(100.0, MIN_LAT, MAX_LAT, "Latitude");
+        assert(result.error == CoordinateError::OutOfRange && result.value == 100.0 && "FAIL: Wrong error details");
+        assert(result.message() == "Latitude must be between -90 and 90" && "FAIL: Wrong range message");
+
+        result = validateCoordinate(std::numeric_limits<double>::quiet_NaN(), MIN_LON, MAX_LON, "Longitude");
+        assert(result.message() == "Longitude must be finite" && "FAIL: Wrong finite message");
+
+        double value;
+        assert(parseCoordinate("12x", value).message() == "Invalid number format" && "FAIL: Wrong format message");
+        assert(parseCoordinate("", value).message() == "Invalid input length" && "FAIL: Wrong length message");
+
+        // A short buffer gets a truncated, terminated message and the full
+        // length. The size is read at run time so the compiler does not warn
+        // about the truncation the test asks for.
+        volatile size_t textSize = 9;
+        std::vector<char> text(textSize);
+        size_t length = validateCoordinate(-200.0, MIN_LON, MAX_LON, "Longitude").formatMessage(text.data(), text.size());
+        assert(length == std::strlen("Longitude must be between -180 and 180") &&
+               std::string(text.data()) == "Longitud" && "FAIL: Wrong truncation");
+    }
+
+    // Test 8: File validation with tiny chunks split across threads
+    {
+        const char* path = "/tmp/coords_final_test.csv";
+        const char* rejectPath = "/tmp/coords_final_test.rejects";
+        std::ofstream(path) << "lat,lon\n12.5,45.25\n91,0\n10\nabc,5\n -45.5 , 179.9 \r\n\n0,-181\ninf,0";
+        CoordinateFileOptions options;
+        options.threads = 3;
+        options.chunkBytes = 8;
+        CoordinateFileReport report;
+        bool ok = validateCoordinateFile(path, options, report, rejectPath);
+        assert(ok && report.rows == 7 && report.valid == 2 && report.rejected == 5 && "FAIL: Wrong CSV counts");
+
+        std::ifstream rejects(rejectPath);
+        std::string text((std::istreambuf_iterator<char>(rejects)), std::istreambuf_iterator<char>());
+        assert(text == "3\tLatitude\tLatitude must be between -90 and 90\n"
+                       "4\tLongitude\tLongitude is missing\n"
+                       "5\tLatitude\tInvalid number format\n"
+                       "8\tLongitude\tLongitude must be between -180 and 180\n"
+                       "9\tLatitude\tInvalid number format\n" && "FAIL: Wrong reject file");
+
+        // The header is the first non-blank line, even after blank lines
+        std::ofstream(path) << "\n  \n  lat,lon\n12.5,45.25\n91,0\n";
+        ok = validateCoordinateFile(path, options, report);
+        assert(ok && report.rows == 2 && report.valid == 1 && "FAIL: Indented CSV header counted as a row");
+
+        // A reject file that cannot be written is reported with its errno
+        ok = validateCoordinateFile(path, options, report, "/dev/full");
+        assert(!ok && report.error == ENOSPC && report.rejected == 1 && "FAIL: Reject write error not reported");
+        ok = validateCoordinateFile("/nonexistent/coords.csv", options, report);
+        assert(!ok && report.error == ENOENT && "FAIL: Open error not reported");
+
+        // A malformed first row is validated, not skipped as a header
+        const char* firstRows[] = { "inf,0", "nan,1\n1,2\n", "abc,5\n1,2\n", "\"Lat\" , LONGITUDE\r\n1,2\n" };
+        const uint64_t firstRowCounts[][2] = { { 1, 1 }, { 2, 1 }, { 2, 1 }, { 1, 0 } };
+        for (size_t i = 0; i < 4; i++) {
+            std::ofstream(path) << firstRows[i];
+            ok = validateCoordinateFile(path, options, report);
+            assert(ok && report.rows == firstRowCounts[i][0] && report.rejected == firstRowCounts[i][1] &&
+                   "FAIL: First row taken for a header or a header validated");
+        }
+
+        std::ofstream(path) << "{\"lat\": 1.5, \"lon\": 2}\n{\"lon\": 3, \"lat\": 95}\n{\"lat\": 1}\n";
+        ok = validateCoordinateFile(path, CoordinateFileOptions(), report);
+        assert(ok && report.rows == 3 && report.valid == 1 && "FAIL: Wrong NDJSON counts");
+        std::remove(path);
+        std::remove(rejectPath);
+    }
+
+    // Test 9: Compile-time validators agree with validateCoordinate
+    {
+        static_assert(Validator<Latitude>::accepts(MAX_LAT) && Validator<Latitude>::accepts(MIN_LAT),
+                      "FAIL: Rejects latitude bounds");
+        static_assert(Validator<Latitude>::accepts(MAX_LAT + EPSILON / 2), "FAIL: Rejects latitude within EPSILON");
+        static_assert(!Validator<Latitude>::accepts(MAX_LAT + EPSILON * 2), "FAIL: Accepts above maximum");
+        static_assert(!Validator<Latitude>::accepts(MIN_LAT - EPSILON * 2), "FAIL: Accepts below minimum");
+        static_assert(Validator<Longitude>::accepts(MIN_LON) && !Validator<Longitude>::accepts(MAX_LON + 0.5),
+                      "FAIL: Wrong longitude bounds");
+        static_assert(!Validator<Latitude>::accepts(std::numeric_limits<double>::infinity()), "FAIL: Accepts infinity");
+        static_assert(!Validator<Longitude>::accepts(-std::numeric_limits<double>::infinity()),
+                      "FAIL: Accepts -infinity");
+        static_assert(!Validator<Latitude>::accepts(std::numeric_limits<double>::quiet_NaN()), "FAIL: Accepts NaN");
+        static_assert(Validator<Bearing>::accepts(360.0) && !Validator<Bearing>::accepts(-1.0),
+                      "FAIL: Wrong bearing bounds");
+        static_assert(!Validator<Altitude>::accepts(-501.0), "FAIL: Wrong altitude bounds");
+
+        // Failures carry the same details and message as validateCoordinate
+        const double values[] = { 95.0, -90.0, std::numeric_limits<double>::quiet_NaN(), MIN_LAT - EPSILON * 2 };
+        for (double value : values) {
+            ValidationResult expected = validateCoordinate(value, MIN_LAT, MAX_LAT, "Latitude");
+            ValidationResult actual = Validator<Latitude>::validate(value);
+            assert(actual.isValid == expected.isValid && actual.error == expected.error &&
+                   actual.message() == expected.message() && "FAIL: Validator disagrees");
+        }
+    }
+
+    // Test 10: Spatial index queries match a linear scan, across the antimeridian and poles
+    {
+        std::mt19937 rng(10);
+        std::uniform_real_distribution<double> lat(-90.0, 90.0), lon(-180.0, 180.0);
+        std::vector<double> lats, lons;
+        for (int i = 0; i < 20000; i++) {
+            lats.push_back(lat(rng));
+            lons.push_back(lon(rng));
+        }
+        // Both ends of the antimeridian, the poles and two invalid points
+        const double extras[][2] = { { 10.0, 180.0 }, { 10.0, -180.0 }, { 90.0, 0.0 }, { -90.0, 45.0 },
+                                     { 91.0, 0.0 }, { 0.0, std::numeric_limits<double>::quiet_NaN() } };
+        for (const auto& extra : extras) {
+            lats.push_back(extra[0]);
+            lons.push_back(extra[1]);
+        }
+        CoordinateIndex index(lats.data(), lons.data(), lats.size(), 16);
+        assert(index.size() == lats.size() - 2 && index.rejected() == 2 && "FAIL: Indexed invalid points");
+
+        auto inBox = [&](const CoordinateBox& box, size_t i) {
+            double offset = std::fmod(lons[i] - box.west + 720.0, 360.0);
+            double span = std::fmod(box.east - box.west + 720.0, 360.0);
+            bool full = box.east - box.west >= 360.0;
+            return lats[i] >= box.south && lats[i] <= box.north && (full || offset <= span);
+        };
+        const CoordinateBox boxes[] = { { -10, -20, 30, 40 }, { 0, 170, 20, -170 }, { 5, 179, 15, -179 },
+                                        { 80, -180, 90, 180 }, { -90, 100, -60, 120 }, { 10, 180, 10, 180 } };
+        for (const CoordinateBox& box : boxes) {
+            std::vector<uint32_t> found;
+            index.queryBox(box, found);
+            std::sort(found.begin(), found.end());
+            std::vector<uint32_t> expected;
+            for (size_t i = 0; i < lats.size() - 2; i++) {
+                if (inBox(box, i)) expected.push_back(static_cast<uint32_t>(i));
+            }
+            assert(found == expected && "FAIL: Box query differs from scan");
+        }
+        std::vector<uint32_t> meridian;
+        index.queryBox(CoordinateBox{ 10, 180, 10, 180 }, meridian);
+        assert(meridian.size() == 2 && "FAIL: +180 and -180 are not the same meridian");
+
+        const double circles[][3] = { { 0, 0, 500 }, { 10, 179.5, 300 }, { -5, -179.9, 1500 },
+                                      { 88, 30, 400 }, { -89.5, -100, 200 }, { 45, 90, 25000 } };
+        for (const auto& circle : circles) {
+            std::vector<uint32_t> found;
+            index.queryRadius(circle[0], circle[1], circle[2], found);
+            std::sort(found.begin(), found.end());
+            std::vector<uint32_t> expected;
+            for (size_t i = 0; i < lats.size() - 2; i++) {
+                if (haversineKm(circle[0], circle[1], lats[i], lons[i]) <= circle[2]) {
+                    expected.push_back(static_cast<uint32_t>(i));
+                }
+            }
+            assert(found == expected && "FAIL: Radius query differs from scan");
+        }
+        assert(std::fabs(haversineKm(0, 179.5, 0, -179.5) - 111.195) < 0.01 && "FAIL: Wrong distance across antimeridian");
+    }
+
+    // Test 11: Fixed-point encoding round trips, at the EPSILON bounds too
+    {
+        const double bounds[][3] = {
+            { MIN_LAT, MIN_LAT, MAX_LAT }, { MAX_LAT, MIN_LAT, MAX_LAT },
+            { MIN_LAT - EPSILON, MIN_LAT, MAX_LAT }, { MAX_LAT + EPSILON, MIN_LAT, MAX_LAT },
+            { MIN_LON - EPSILON, MIN_LON, MAX_LON }, { MAX_LON + EPSILON, MIN_LON, MAX_LON }, { -0.0, MIN_LON, MAX_LON }
+        };
+        for (const auto& bound : bounds) {
+            double decoded = decodeDegrees(encodeDegrees(bound[0]));
+            assert(std::fabs(decoded - bound[0]) <= 0.5 / PACKED_UNITS_PER_DEGREE && "FAIL: Round trip error");
+            assert(validateCoordinate(decoded, bound[1], bound[2], "Value").isValid && "FAIL: Decoded value invalid");
+        }
+        assert(encodeDegrees(MAX_LON + EPSILON) == 1800000000 && "FAIL: Wrong scale");
+
+        // Seven-decimal text decodes to exactly the parsed value
+        std::mt19937 rng(11);
+        const size_t count = 1003;
+        std::vector<double> lat(count), lon(count);
+        char text[32];
+        for (size_t i = 0; i < count; i++) {
+            double parsed;
+            std::snprintf(text, sizeof(text), "%.7f", std::uniform_real_distribution<double>(-90.0, 90.0)(rng));
+            parseCoordinate(text, parsed);
+            lat[i] = parsed;
+            std::snprintf(text, sizeof(text), "%.7f", std::uniform_real_distribution<double>(-180.0, 180.0)(rng));
+            parseCoordinate(text, parsed);
+            lon[i] = parsed;
+        }
+
+        const CoordinateSimd levels[] = { CoordinateSimd::Scalar, CoordinateSimd::Avx2, CoordinateSimd::Avx512 };
+        std::vector<PackedCoordinate> expected(count);
+        encodeCoordinates(lat.data(), lon.data(), count, expected.data(), CoordinateSimd::Scalar);
+        for (CoordinateSimd simd : levels) {
+            std::vector<PackedCoordinate> packed(count);
+            std::vector<double> lat2(count), lon2(count);
+            encodeCoordinates(lat.data(), lon.data(), count, packed.data(), simd);
+            decodeCoordinates(packed.data(), count, lat2.data(), lon2.data(), simd);
+            for (size_t i = 0; i < count; i++) {
+                assert(packed[i].lat == expected[i].lat && packed[i].lon == expected[i].lon &&
+                       "FAIL: SIMD encoding differs");
+                assert(lat2[i] == lat[i] && lon2[i] == lon[i] && "FAIL: Seven-decimal value not exact");
+            }
+        }
+
+        // Delta-encoded tracks, including a jump across the antimeridian
+        expected[10].lon = encodeDegrees(MAX_LON + EPSILON);
+        expected[11].lon = encodeDegrees(MIN_LON - EPSILON);
+        std::vector<uint8_t> track;
+        encodeTrack(expected.data(), count, track);
+        std::vector<PackedCoordinate> points;
+        assert(decodeTrack(track.data(), track.size(), points) && points.size() == count && "FAIL: Track lost points");
+        for (size_t i = 0; i < count; i++) {
+            assert(points[i].lat == expected[i].lat && points[i].lon == expected[i].lon && "FAIL: Track round trip");
+        }
+        points.clear();
+        assert(!decodeTrack(track.data(), track.size() - 1, points) && points.size() == count - 1 &&
+               "FAIL: Accepts truncated track");
+    }
+
+    // Test 12: Line reader over a pipe, and getInput reading from it
+    {
+        auto pipeReader = [](const std::string& text, int& fd) {
+            int fds[2];
+            bool ok = pipe(fds) == 0;
+            ok = ok && write(fds[1], text.data(), text.size()) == static_cast<ssize_t>(text.size());
+            assert(ok && "FAIL: Cannot fill pipe");
+            close(fds[1]);
+            fd = fds[0];
+        };
+
+        // A 4-byte block forces lines across refills and buffer growth
+        const std::string text = "12.5\n\n-45.123456789012\r\n" + std::string(100, '7') + "\nlast";
+        const char* lines[] = { "12.5", "", "-45.123456789012\r", nullptr, "last" };
+        const size_t blocks[] = { 4, 64 << 10 };
+        for (size_t block : blocks) {
+            int fd;
+            pipeReader(text, fd);
+            CoordinateLineReader reader(fd, block);
+            CoordinateLine line;
+            for (const char* expected : lines) {
+                assert(reader.next(line) && "FAIL: Missing line");
+                assert(line.str() == (expected != nullptr ? std::string(expected) : std::string(100, '7')) &&
+                       "FAIL: Wrong line");
+            }
+            assert(!reader.next(line) && !reader.next(line) && !reader.failed() && "FAIL: Line after end");
+            close(fd);
+        }
+
+        // Same results as the std::cin version
+        const char* inputs[] = { "45.5\n", "abc\n 12 \n", "abc\n123abc\n\nignored\n", "", "abc\n" };
+        const CoordinateError expected[] = { CoordinateError::None, CoordinateError::None,
+                                             CoordinateError::MaxAttempts, CoordinateError::InputStream,
+                                             CoordinateError::InputStream };
+        const double values[] = { 45.5, 12.0 };
+        for (int k = 0; k < 5; k++) {
+            int fd;
+            pipeReader(inputs[k], fd);
+            CoordinateLineReader reader(fd);
+            double value = 0;
+            ValidationResult result = getInput(reader, "", value);
+            assert(result.error == expected[k] && "FAIL: getInput(reader) result differs");
+            if (k < 2) assert(value == values[k] && "FAIL: getInput(reader) value");
+            close(fd);
+        }
+    }
+
+    // Test 13: Batch distance kernels match haversineKm at every SIMD level
+    {
+        std::mt19937 rng(13);
+        std::uniform_real_distribution<double> lat(-90.0, 90.0), lon(-180.0, 180.0), nearby(-0.01, 0.01);
+        const size_t count = 1001;
+        std::vector<double> lat1(count), lon1(count), lat2(count), lon2(count);
+        for (size_t i = 0; i < count; i++) {
+            lat1[i] = lat(rng);
+            lon1[i] = lon(rng);
+            bool close = i % 2 == 0;
+            lat2[i] = close ? std::max(MIN_LAT, std::min(MAX_LAT, lat1[i] + nearby(rng))) : lat(rng);
+            lon2[i] = close ? lon1[i] + nearby(rng) : lon(rng);
+        }
+        // Same point, antipodes, the antimeridian from both sides and the EPSILON bounds
+        const double special[][4] = {
+            { 12.5, 45.0, 12.5, 45.0 }, { 0, 0, 0, 180 }, { MAX_LAT, 0, MIN_LAT, 0 }, { 10, 180, 10, -180 },
+            { 0, 179.5, 0, -179.5 }, { MAX_LAT + EPSILON, MAX_LON + EPSILON, MIN_LAT - EPSILON, MIN_LON - EPSILON }
+        };
+        for (size_t k = 0; k < 6; k++) {
+            lat1[k] = special[k][0];
+            lon1[k] = special[k][1];
+            lat2[k] = special[k][2];
+            lon2[k] = special[k][3];
+        }
+
+        const double pi = 3.14159265358979323846;
+        const CoordinateSimd levels[] = { CoordinateSimd::Scalar, CoordinateSimd::Avx2, CoordinateSimd::Avx512 };
+        for (CoordinateSimd simd : levels) {
+            std::vector<double> km(count);
+            haversineDistances(lat1.data(), lon1.data(), lat2.data(), lon2.data(), count, km.data(), simd);
+            for (size_t i = 0; i < count; i++) {
+                double expected = haversineKm(lat1[i], lon1[i], lat2[i], lon2[i]);
+                assert(std::fabs(km[i] - expected) <= 1e-7 && "FAIL: Distance differs from haversineKm");
+            }
+            assert(km[0] == 0 && "FAIL: Nonzero distance to the same point");
+            assert(std::fabs(km[1] - pi * EARTH_RADIUS_KM) < 1e-9 && std::fabs(km[2] - pi * EARTH_RADIUS_KM) < 1e-9 &&
+                   "FAIL: Wrong antipodal distance");
+            assert(km[3] < 1e-9 && "FAIL: +180 and -180 are apart");
+
+            // One-to-many and a threaded matrix spanning several column tiles
+            const size_t rows = 37, cols = 1500;
+            std::vector<double> colLat(cols), colLon(cols), matrix(rows * cols), from(cols);
+            for (size_t c = 0; c < cols; c++) {
+                colLat[c] = lat(rng);
+                colLon[c] = lon(rng);
+            }
+            distanceMatrix(lat1.data(), lon1.data(), rows, colLat.data(), colLon.data(), cols, matrix.data(), 3, simd);
+            for (size_t r = 0; r < rows; r++) {
+                distancesFrom(lat1[r], lon1[r], colLat.data(), colLon.data(), cols, from.data(), simd);
+                for (size_t c = 0; c < cols; c++) {
+                    assert(matrix[r * cols + c] == from[c] && "FAIL: Matrix row differs from distancesFrom");
+                    assert(std::fabs(from[c] - haversineKm(lat1[r], lon1[r], colLat[c], colLon[c])) <= 1e-7 &&
+                           "FAIL: distancesFrom differs from haversineKm");
+                }
+            }
+
+            // 0 x N and N x 0 matrices have no cells and write nothing
+            std::vector<double> none;
+            matrix.assign(1, -1.0);
+            distanceMatrix(none.data(), none.data(), 0, colLat.data(), colLon.data(), cols, matrix.data(), 3, simd);
+            distanceMatrix(lat1.data(), lon1.data(), rows, none.data(), none.data(), 0, matrix.data(), 3, simd);
+            assert(matrix[0] == -1.0 && "FAIL: Empty matrix wrote a cell");
+        }
+    }
+
     // Restore cin to standard input
     std::cin.rdbuf(std::cin.rdbuf());
     std::cout << "All tests passed!\n\n";
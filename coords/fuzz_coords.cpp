@@ -0,0 +1,300 @@
+// Differential fuzzing of every coordinate parser against the istringstream
+// reference, parseCoordinateReference. Checks do not use assert, so they
+// also run in -DNDEBUG builds.
+//
+// Standalone:
+//   g++ -std=c++11 -O2 -pthread fuzz_coords.cpp -o fuzz_coords
+//   ./fuzz_coords                        edge cases, then 1000000 generated inputs
+//   ./fuzz_coords fuzz [inputs] [seed]
+//   ./fuzz_coords replay <file>...       check saved inputs, e.g. libFuzzer crashes
+//   ./fuzz_coords corpus <dir> [inputs]  write edge cases and generated inputs as a seed corpus
+//   ./fuzz_coords bench [inputs]         check, then time each parser on the generated corpus
+//
+// libFuzzer (clang):
+//   clang++ -std=c++11 -g -O1 -fsanitize=fuzzer,address,undefined -DCOORDINATE_LIBFUZZER
+//       fuzz_coords.cpp -o fuzz_coords_libfuzzer
+//   ./fuzz_coords_libfuzzer corpus_dir
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "coordinate.h"
+#include "coordinate_validator.h"
+#include "coordinate_file.h"
+using namespace std;
+
+// Inputs whose handling is easy to get subtly wrong: signs, whitespace,
+// forms istringstream rejects (hex, inf, nan), the ends of the double
+// range, and lengths either side of MAX_COORDINATE_LENGTH
+vector<string> edgeCases() {
+    const char* texts[] = {
+        "0", "-0", "+0", "+45.5", "++1", "+-1", "-+1", "-", "+", ".", "-.", ".5", "5.", "-.5e1", "+.e1",
+        " 45", "45 ", "\t45\n", "\v\f\r 1", " ", "1 2", "4 5.", "12,5", "1..2", "1.2.3", "1e5.5", "1e", "1e+",
+        "1e-", "1E5", "1e+05", "e5", "0x1p3", "0X1A", "0x", "0x1.8p1", "inf", "-inf", "INF", "nan", "NaN",
+        "infinity", "nan(1)", "1e308", "1.7976931348623157e308", "1.7976931348623158e308",
+        "1.7976931348623159e308", "1e309", "-1e309", "4.9e-324", "4.9406564584124654e-324", "2.4e-324",
+        "2.5e-324", "1e-400", "-1e-400", "2.2250738585072011e-308", "2.2250738585072014e-308", "-90.0e999",
+        "1e99999999999", "1e-99999999999", "0e99999999999", "123abc", "abc", "90", "-90.0000000001",
+        "180.00000000005", "9007199254740992", "9007199254740993", "90071992547409931", "1234567890123456789",
+        "12345678901234567890", "0.30000000000000004", "179.99999999999999999", "000000000000000000000001.5",
+        "0.000000000000000000000000000001e30", "1e22", "1e23", "1e-22", "1e-23", "45.12345678"
+    };
+    vector<string> cases(texts, texts + sizeof(texts) / sizeof(texts[0]));
+    cases.push_back("");
+    cases.push_back(string("1\0", 2));
+    cases.push_back(string("\0" "1", 2));
+    cases.push_back(string(50, '9'));
+    cases.push_back(string(51, '9'));
+    cases.push_back(string(49, ' ') + "1");
+    cases.push_back(string(50, ' ') + "1");
+    cases.push_back("1" + string(49, '0'));
+    cases.push_back("0." + string(48, '1'));
+    cases.push_back("-0." + string(48, '1'));
+    cases.push_back("1e-" + string(47, '0'));
+    return cases;
+}
+
+// Mostly near-valid inputs: random characters from the number alphabet,
+// printf output across the whole double range, long digit strings, and
+// byte-level mutations of the edge cases
+string generateInput(mt19937_64& rng, const vector<string>& seeds) {
+    static const char alphabet[] = "0000123456789999+-..eeE \t\v\f\r\nxXpinfa";
+    string s;
+    switch (rng() % 5) {
+    case 0: {
+        size_t length = rng() % 56;
+        for (size_t k = 0; k < length; k++) s += alphabet[rng() % (sizeof(alphabet) - 1)];
+        break;
+    }
+    case 1: {
+        char text[80];
+        double value;
+        uint64_t bits = rng();
+        memcpy(&value, &bits, sizeof(value));
+        const char* format = rng() % 3 == 0 ? "%.*g" : rng() % 2 ? "%.*e" : "%.*f";
+        snprintf(text, sizeof(text), format, static_cast<int>(rng() % 25), value);
+        s = text;
+        break;
+    }
+    case 2: {
+        int digits = 1 + static_cast<int>(rng() % 30);
+        if (rng() % 2) s += rng() % 2 ? '-' : '+';
+        int point = static_cast<int>(rng() % (digits + 1));
+        for (int k = 0; k < digits; k++) {
+            if (k == point) s += '.';
+            s += static_cast<char>('0' + rng() % 10);
+        }
+        if (rng() % 2) s += (rng() % 2 ? "e" : "E") + to_string(static_cast<long>(rng() % 700) - 350);
+        break;
+    }
+    case 3: {
+        s = seeds[rng() % seeds.size()];
+        for (int edits = 1 + static_cast<int>(rng() % 3); edits > 0; edits--) {
+            size_t at = s.empty() ? 0 : rng() % (s.size() + 1);
+            char c = rng() % 4 == 0 ? static_cast<char>(rng()) : alphabet[rng() % (sizeof(alphabet) - 1)];
+            int op = static_cast<int>(rng() % 3);
+            if (op == 0 || s.empty()) s.insert(s.begin() + at, c);
+            else if (op == 1 && at < s.size()) s.erase(at, 1);
+            else if (at < s.size()) s[at] = c;
+        }
+        break;
+    }
+    default: {
+        // Padded to within a few bytes of the length limit
+        char text[40];
+        snprintf(text, sizeof(text), "%.*f", static_cast<int>(rng() % 12), (static_cast<double>(rng() % 36000) - 18000) / 100);
+        s = text;
+        size_t target = MAX_COORDINATE_LENGTH - 2 + rng() % 4;
+        if (s.size() < target) {
+            size_t pad = target - s.size();
+            int where = static_cast<int>(rng() % 3);
+            if (where == 0) s = string(pad, '0') + s;
+            else if (where == 1) s = string(pad, ' ') + s;
+            else s += string(pad, ' ');
+        }
+        break;
+    }
+    }
+    return s;
+}
+
+string escape(const string& input) {
+    string out;
+    char hex[8];
+    for (unsigned char c : input) {
+        if (c >= 0x20 && c < 0x7F && c != '\\') {
+            out += static_cast<char>(c);
+        } else {
+            snprintf(hex, sizeof(hex), "\\x%02x", c);
+            out += hex;
+        }
+    }
+    return out;
+}
+
+bool sameResult(const ValidationResult& a, double aValue, const ValidationResult& b, double bValue) {
+    return a.isValid == b.isValid && a.error == b.error &&
+           (!a.isValid || memcmp(&aValue, &bValue, sizeof(double)) == 0);
+}
+
+// Runs every parser on input and compares it with the reference. Returns
+// false after printing the disagreement.
+bool checkInput(const string& input) {
+    double expected = 0;
+    ValidationResult reference = parseCoordinateReference(input, expected);
+    const char* failure = nullptr;
+    double value = 0;
+
+    if (reference.isValid && !std::isfinite(expected)) failure = "reference accepted a non-finite value";
+
+    ValidationResult result = parseCoordinate(input, value);
+    if (failure == nullptr && !sameResult(result, value, reference, expected)) failure = "parseCoordinate(string)";
+
+    // An exact-size heap copy, so a sanitizer catches reads past the end
+    if (failure == nullptr) {
+        vector<char> copy(input.begin(), input.end());
+        const char* begin = copy.empty() ? nullptr : copy.data();
+        value = 0;
+        result = parseCoordinate(begin, begin + copy.size(), value);
+        if (!sameResult(result, value, reference, expected)) failure = "parseCoordinate(begin, end)";
+
+        // The file validator's field check is the parse plus Validator
+        CoordinateError fieldError = coordinate_file_detail::checkField<Latitude>(begin, begin + copy.size(), true);
+        CoordinateError expectedError = reference.isValid ? Validator<Latitude>::validate(expected).error : reference.error;
+        if (failure == nullptr && fieldError != expectedError) failure = "checkField<Latitude>";
+    }
+
+    if (failure == nullptr) return true;
+    fprintf(stderr, "MISMATCH in %s for \"%s\" (%zu bytes)\n  reference: valid %d error %d value %.17g\n",
+            failure, escape(input).c_str(), input.size(), reference.isValid, static_cast<int>(reference.error),
+            expected);
+    return false;
+}
+
+#ifdef COORDINATE_LIBFUZZER
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (!checkInput(string(reinterpret_cast<const char*>(data), size))) abort();
+    return 0;
+}
+
+#else
+
+// Checks the edge cases and then count generated inputs
+bool fuzz(long count, uint64_t seed) {
+    vector<string> seeds = edgeCases();
+    for (size_t i = 0; i < seeds.size(); i++) {
+        if (!checkInput(seeds[i])) return false;
+    }
+    mt19937_64 rng(seed);
+    long accepted = 0;
+    for (long i = 0; i < count; i++) {
+        string input = generateInput(rng, seeds);
+        if (!checkInput(input)) return false;
+        double value;
+        accepted += parseCoordinateReference(input, value).isValid;
+    }
+    cout << "checked " << seeds.size() << " edge cases and " << count << " generated inputs (seed " << seed
+         << "), " << accepted << " of them valid numbers\n";
+    return true;
+}
+
+bool replay(int count, char** paths) {
+    for (int i = 0; i < count; i++) {
+        FILE* file = fopen(paths[i], "rb");
+        if (file == nullptr) {
+            perror(paths[i]);
+            return false;
+        }
+        string input;
+        char block[4096];
+        for (size_t n; (n = fread(block, 1, sizeof(block), file)) > 0;) input.append(block, n);
+        fclose(file);
+        if (!checkInput(input)) return false;
+    }
+    cout << "replayed " << count << " inputs\n";
+    return true;
+}
+
+// The generated corpus shared by the corpus and bench modes
+vector<string> generatedCorpus(long count) {
+    vector<string> seeds = edgeCases();
+    vector<string> corpus = seeds;
+    mt19937_64 rng(20240501);
+    while (static_cast<long>(corpus.size()) < count) corpus.push_back(generateInput(rng, seeds));
+    return corpus;
+}
+
+bool writeCorpus(const char* dir, long count) {
+    vector<string> corpus = generatedCorpus(count);
+    char path[4096];
+    for (size_t i = 0; i < corpus.size(); i++) {
+        snprintf(path, sizeof(path), "%s/seed_%06zu", dir, i);
+        FILE* file = fopen(path, "wb");
+        if (file == nullptr || fwrite(corpus[i].data(), 1, corpus[i].size(), file) != corpus[i].size()) {
+            perror(path);
+            if (file != nullptr) fclose(file);
+            return false;
+        }
+        fclose(file);
+    }
+    cout << "wrote " << corpus.size() << " inputs to " << dir << "\n";
+    return true;
+}
+
+// Best-of-5 throughput of each parser over the generated corpus, after
+// checking that they all agree on it
+bool bench(long count) {
+    vector<string> corpus = generatedCorpus(count);
+    for (size_t i = 0; i < corpus.size(); i++) {
+        if (!checkInput(corpus[i])) return false;
+    }
+    cout << "\n== parser throughput, " << corpus.size() << " corpus inputs ==\n";
+    const char* names[] = { "istringstream", "parseCoordinate(string)", "parseCoordinate(begin, end)" };
+    for (int k = 0; k < 3; k++) {
+        double best = 0;
+        long accepted = 0;
+        for (int rep = 0; rep < 5; rep++) {
+            accepted = 0;
+            double value;
+            auto start = chrono::steady_clock::now();
+            for (size_t i = 0; i < corpus.size(); i++) {
+                const string& input = corpus[i];
+                if (k == 0) accepted += parseCoordinateReference(input, value).isValid;
+                else if (k == 1) accepted += parseCoordinate(input, value).isValid;
+                else accepted += parseCoordinate(input.data(), input.data() + input.size(), value).isValid;
+            }
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            if (rep == 0 || ms < best) best = ms;
+        }
+        cout << left << setw(30) << names[k] << right << setw(10) << fixed << setprecision(1) << best << " ms"
+             << setw(10) << corpus.size() / best / 1000.0 << " Mvalues/s  accepted " << accepted << "\n";
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    string mode = argc > 1 ? argv[1] : "fuzz";
+    bool ok;
+    if (mode == "fuzz") {
+        ok = fuzz(argc > 2 ? atol(argv[2]) : 1000000, argc > 3 ? strtoull(argv[3], nullptr, 10) : 1);
+    } else if (mode == "replay") {
+        ok = replay(argc - 2, argv + 2);
+    } else if (mode == "corpus" && argc > 2) {
+        ok = writeCorpus(argv[2], argc > 3 ? atol(argv[3]) : 1000);
+    } else if (mode == "bench") {
+        ok = bench(argc > 2 ? atol(argv[2]) : 1000000);
+    } else {
+        cerr << "usage: " << argv[0] << " [fuzz [inputs] [seed] | replay <file>... | corpus <dir> [inputs]"
+             << " | bench [inputs]]\n";
+        return 2;
+    }
+    return ok ? 0 : 1;
+}
+
+#endif